@@ -1,16 +1,27 @@
 #!/usr/bin/env python3
 
 
-def main(p, g, *, pow=False, log=False):
+# carry-less multiplication mod p, this is slow but doesn't need any
+# tables
+def gf_mul_slow(a, b, p):
+    x = 0
+    for i in range(8):
+        if b & (1 << i):
+            x ^= a << i
+
+    for i in reversed(range(8, 16)):
+        if x & (1 << i):
+            x ^= p << (i-8)
+
+    return x
+
+def main(p, g, *, pow=False, log=False, speed=False):
     if not pow and not log:
         pow = True
         log = True
 
-    assert g == 2
-
-    # generate the pow table via repeated multiplications by a generator
-    # (assumed to be 2), keep track of the inverse mapping which is the
-    # log table
+    # generate the pow table via repeated multiplications by a generator,
+    # keep track of the inverse mapping which is the log table
     pow_table = []
     log_table = {}
 
@@ -20,41 +31,62 @@ def main(p, g, *, pow=False, log=False):
         if x not in log_table:
             log_table[x] = i
 
-        x <<= 1
-        if x & 0x100:
-            x ^= p
+        x = gf_mul_slow(x, g, p)
+
+    # make sure g is actually a generator
+    assert len(log_table) == 255, "0x%02x is not a generator of 0x%03x" % (
+        g, p)
 
     # print the pow table
+    #
+    # the speed profile's pow table is extended so we can skip the
+    # mod 255, with a run of zeros past 2*255 for log 0
+    #
     if pow:
-        print("// power table, RAMRSBD_GF_POW[x] = g^x")
-        print("static const uint8_t RAMRSBD_GF_POW[256] = {")
-        for j in range(256//8):
+        if speed:
+            print("// power table, RAMRSBD_GF_POW[x] = g^(x mod 255), or 0 "
+                "for x >= 510")
+            print("const uint8_t RAMRSBD_GF_POW[1024] = {")
+            pow_table_ = [pow_table[x % 255] if x < 2*255 else 0
+                for x in range(1024)]
+        else:
+            print("// power table, RAMRSBD_GF_POW[x] = g^x")
+            print("static const uint8_t RAMRSBD_GF_POW[256] = {")
+            pow_table_ = pow_table
+        for j in range(len(pow_table_)//8):
             print("    ", end='')
             for i in range(8):
                 print("%s0x%02x," % (
                     " " if i != 0 else "",
-                    pow_table[j*8+i]),
+                    pow_table_[j*8+i]),
                     end='')
             print()
         print("};")
         print()
 
     # print the log table
+    #
+    # the speed profile's log table maps 0 to 510, so any product
+    # involving 0 lands in the zeros at the end of the pow table
+    #
     if log:
-        print("// log table, RAMRSBD_GF_LOG[x] = log_g x")
-        print("static const uint8_t RAMRSBD_GF_LOG[256] = {")
+        if speed:
+            print("// log table, RAMRSBD_GF_LOG[x] = log_g x, or 510 for x = 0")
+            print("const uint16_t RAMRSBD_GF_LOG[256] = {")
+        else:
+            print("// log table, RAMRSBD_GF_LOG[x] = log_g x")
+            print("static const uint8_t RAMRSBD_GF_LOG[256] = {")
         for j in range(256//8):
             print("    ", end='')
             for i in range(8):
-                print("%s0x%02x," % (
+                print(("%s0x%03x," if speed else "%s0x%02x,") % (
                     " " if i != 0 else "",
-                    log_table.get(j*8+i, 0xff)),
+                    log_table.get(j*8+i, 2*255 if speed else 0xff)),
                     end='')
             print()
         print("};")
         print()
 
-
 if __name__ == "__main__":
     import sys
     import argparse
@@ -74,7 +106,7 @@ if __name__ == "__main__":
         nargs='?',
         type=lambda x: int(x, 0),
         default=0x02,
-        help="A generator element in the field, must be 2. Defaults to 2.")
+        help="A generator element in the field. Defaults to 2.")
     parser.add_argument(
         '--pow',
         action='store_true',
@@ -83,6 +115,11 @@ if __name__ == "__main__":
         '--log',
         action='store_true',
         help="Generate the GF_LOG table. Defaults to generating both.")
+    parser.add_argument(
+        '-s', '--speed',
+        action='store_true',
+        help="Generate the larger, zero-aware tables used by "
+            "RAMRSBD_PROFILE_SPEED.")
     sys.exit(main(**{k: v
         for k, v in vars(parser.parse_args()).items()
         if v is not None}))
@@ -4,10 +4,315 @@
  * Copyright (c) 2024, The littlefs authors.
  * SPDX-License-Identifier: BSD-3-Clause
  */
+#ifdef RAMRSBD_YES_MMAP
+// mmap and friends are POSIX, not C99
+#define _DEFAULT_SOURCE
+#endif
+
 #include "ramrsbd.h"
 
 #include "ramrsbd_gf.h"
 #include "ramrsbd_gf_p.h"
+#include "ramrsbd_rs.h"
+#include "ramrsbd_bch.h"
+
+#ifdef RAMRSBD_YES_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef RAMRSBD_YES_MMAP
+// map our buffer, either to a file or to anonymous memory
+//
+// both are zero-filled lazily by the OS, so this is O(1) regardless of
+// device size, and an existing file keeps its contents
+static int ramrsbd_mmap(ramrsbd_t *bd) {
+    size_t size = (size_t)bd->cfg->erase_size * bd->cfg->erase_count;
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (bd->cfg->path) {
+        bd->fd = open(bd->cfg->path, O_RDWR | O_CREAT, 0666);
+        if (bd->fd < 0) {
+            return LFS_ERR_IO;
+        }
+
+        struct stat st;
+        if (fstat(bd->fd, &st) < 0) {
+            close(bd->fd);
+            bd->fd = -1;
+            return LFS_ERR_IO;
+        }
+
+        // an existing image must match our geometry, we don't want to
+        // silently truncate a larger image
+        if (st.st_size != 0 && (size_t)st.st_size != size) {
+            close(bd->fd);
+            bd->fd = -1;
+            return LFS_ERR_INVAL;
+        }
+
+        // resize a new image to fit the device, note this reads as zeros
+        if (st.st_size == 0 && ftruncate(bd->fd, size) < 0) {
+            close(bd->fd);
+            bd->fd = -1;
+            return LFS_ERR_IO;
+        }
+
+        flags = MAP_SHARED;
+    }
+
+    void *buffer = mmap(NULL, size,
+            PROT_READ | PROT_WRITE, flags,
+            bd->fd, 0);
+    if (buffer == MAP_FAILED) {
+        if (bd->fd >= 0) {
+            close(bd->fd);
+            bd->fd = -1;
+        }
+        return (bd->cfg->path) ? LFS_ERR_IO : LFS_ERR_NOMEM;
+    }
+
+#ifdef MADV_HUGEPAGE
+    // huge pages are only a hint, so ignore errors
+    if (bd->cfg->huge_pages) {
+        madvise(buffer, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    bd->buffer = buffer;
+    return 0;
+}
+#endif
+
+// copy-on-write/sparse erase blocks, these may be shared between devices
+// and snapshots
+struct ramrsbd_block {
+    // number of devices/snapshots referencing this block
+    lfs_size_t refs;
+    // next free block, if in a pool
+    struct ramrsbd_block *next;
+    uint8_t data[];
+};
+
+#ifdef RAMRSBD_YES_THREADS
+// shared blocks may be referenced from multiple devices, so reference
+// counts, and our pools, need a global lock
+static pthread_mutex_t ramrsbd_block_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void ramrsbd_block_lock(void) {
+#ifdef RAMRSBD_YES_THREADS
+    pthread_mutex_lock(&ramrsbd_block_mutex);
+#endif
+}
+
+static void ramrsbd_block_unlock(void) {
+#ifdef RAMRSBD_YES_THREADS
+    pthread_mutex_unlock(&ramrsbd_block_mutex);
+#endif
+}
+
+// drop a reference to a block, freeing it if it was the last one
+static void ramrsbd_block_decref(struct ramrsbd_block *b) {
+    ramrsbd_block_lock();
+    b->refs -= 1;
+    bool last = (b->refs == 0);
+    ramrsbd_block_unlock();
+
+    if (last) {
+        lfs_free(b);
+    }
+}
+
+// scratch buffers for encoding/decoding codewords, each thread needs its
+// own
+struct ramrsbd_scratch {
+    uint8_t *c; // code_size
+    uint8_t *s; // ecc_size
+    uint8_t *λ; // ecc_size
+    uint8_t *ω; // ecc_size
+    uint64_t *planes; // RAMRSBD_RS_PLANES_SIZE(ecc_size), if bitsliced
+};
+
+// the device's own scratch buffers, used when not on a worker thread
+static struct ramrsbd_scratch ramrsbd_scratch(ramrsbd_t *bd) {
+    return (struct ramrsbd_scratch){bd->c, bd->s, bd->λ, bd->ω, bd->planes};
+}
+
+#ifdef RAMRSBD_YES_THREADS
+// worker thread state
+struct ramrsbd_worker {
+    ramrsbd_t *bd;
+    pthread_t thread;
+    struct ramrsbd_scratch scratch;
+};
+#endif
+
+// predeclared asynchronous request handling
+static void ramrsbd_lock(ramrsbd_t *bd);
+static void ramrsbd_unlock(ramrsbd_t *bd);
+static void ramrsbd_progress(ramrsbd_t *bd);
+static void ramrsbd_flush_all(ramrsbd_t *bd,
+        struct ramrsbd_scratch *scratch);
+#ifdef RAMRSBD_YES_THREADS
+static void *ramrsbd_work(void *p);
+#endif
+
+static lfs_size_t ramrsbd_queue_size(ramrsbd_t *bd) {
+    return (bd->cfg->queue_size) ? bd->cfg->queue_size : 1;
+}
+
+// size of our syndrome/error-locator buffers, binary BCH needs twice the
+// syndromes to correct a bit error per ecc byte
+static lfs_size_t ramrsbd_s_size(ramrsbd_t *bd) {
+    return (bd->cfg->codec == RAMRSBD_CODEC_BCH)
+            ? 2*bd->cfg->ecc_size
+            : bd->cfg->ecc_size;
+}
+
+// number of positions in our decode plan, binary BCH works on bits
+static lfs_size_t ramrsbd_plan_size(ramrsbd_t *bd) {
+    return (bd->cfg->codec == RAMRSBD_CODEC_BCH)
+            ? 8*bd->cfg->code_size
+            : bd->cfg->code_size;
+}
+
+// write a little-endian 32-bit word, used for recording traces
+static void ramrsbd_record_le32(uint8_t *b, uint32_t x) {
+    b[0] = x >> 0;
+    b[1] = x >> 8;
+    b[2] = x >> 16;
+    b[3] = x >> 24;
+}
+
+#ifdef RAMRSBD_YES_THREADS
+// stop our worker threads, waiting for them to finish any queued
+// requests
+static void ramrsbd_stop(ramrsbd_t *bd, lfs_size_t count) {
+    ramrsbd_lock(bd);
+    bd->stopping = true;
+    pthread_cond_broadcast(&bd->work_cond);
+    ramrsbd_unlock(bd);
+
+    for (lfs_size_t i = 0; i < count; i++) {
+        pthread_join(bd->workers[i].thread, NULL);
+        lfs_free(bd->workers[i].scratch.c);
+        lfs_free(bd->workers[i].scratch.planes);
+    }
+}
+#endif
+
+// find where an erase block lives
+//
+// note sparse blocks must be allocated
+static uint8_t *ramrsbd_find_block(ramrsbd_t *bd, lfs_block_t block) {
+    if (bd->blocks) {
+        return bd->blocks[block]->data;
+    } else {
+        return &bd->buffer[block*bd->cfg->erase_size];
+    }
+}
+
+// find where a codeword's message lives in our buffer, given an offset
+// in message space
+//
+// after the first codeword, hot loops should just follow m_stride
+static uint8_t *ramrsbd_find_m(ramrsbd_t *bd,
+        lfs_block_t block, lfs_off_t off) {
+    // map off to codeword space
+    return &ramrsbd_find_block(bd, block)[
+            (off / (bd->cfg->code_size-bd->cfg->ecc_size))
+                * bd->m_stride];
+}
+
+// find where a codeword's ecc lives in our buffer, given an offset in
+// message space
+//
+// after the first codeword, hot loops should just follow e_stride
+static uint8_t *ramrsbd_find_e(ramrsbd_t *bd,
+        lfs_block_t block, lfs_off_t off) {
+    return &ramrsbd_find_block(bd, block)[bd->e_off
+            + (off / (bd->cfg->code_size-bd->cfg->ecc_size))
+                * bd->e_stride];
+}
+
+// allocate an erase block, from our pool if we can
+static struct ramrsbd_block *ramrsbd_block_alloc(ramrsbd_t *bd) {
+    // note other threads may be allocating/releasing other blocks
+    ramrsbd_block_lock();
+    struct ramrsbd_block *b = bd->pool;
+    if (b) {
+        bd->pool = b->next;
+    }
+    ramrsbd_block_unlock();
+
+    if (!b) {
+        b = lfs_malloc(sizeof(struct ramrsbd_block) + bd->cfg->erase_size);
+        if (!b) {
+            return NULL;
+        }
+    }
+
+    b->refs = 1;
+    b->next = NULL;
+    return b;
+}
+
+// release an erase block, returning it to our pool if it was the last
+// reference
+static void ramrsbd_block_release(ramrsbd_t *bd, struct ramrsbd_block *b) {
+    ramrsbd_block_lock();
+    b->refs -= 1;
+    if (b->refs == 0) {
+        b->next = bd->pool;
+        bd->pool = b;
+    }
+    ramrsbd_block_unlock();
+}
+
+// make sure an erase block is allocated and isn't shared before we write
+// to it
+static int ramrsbd_cow(ramrsbd_t *bd, lfs_block_t block) {
+    if (!bd->blocks) {
+        return 0;
+    }
+
+    // not allocated yet? sparse blocks start zeroed
+    struct ramrsbd_block *b = bd->blocks[block];
+    if (!b) {
+        b = ramrsbd_block_alloc(bd);
+        if (!b) {
+            return LFS_ERR_NOMEM;
+        }
+        memset(b->data, 0, bd->cfg->erase_size);
+
+        bd->blocks[block] = b;
+        return 0;
+    }
+
+    // only we reference this block? note other references can't appear
+    // while we're writing, snapshots wait for in-flight requests
+    ramrsbd_block_lock();
+    bool shared = (b->refs > 1);
+    ramrsbd_block_unlock();
+    if (!shared) {
+        return 0;
+    }
+
+    // copy the block, our reference keeps the old block alive
+    struct ramrsbd_block *b_ = ramrsbd_block_alloc(bd);
+    if (!b_) {
+        return LFS_ERR_NOMEM;
+    }
+    memcpy(b_->data, b->data, bd->cfg->erase_size);
+
+    bd->blocks[block] = b_;
+    ramrsbd_block_release(bd, b);
+    return 0;
+}
 
 int ramrsbd_create(const struct lfs_config *cfg,
         const struct ramrsbd_config *bdcfg) {
@@ -15,15 +320,17 @@ int ramrsbd_create(const struct lfs_config *cfg,
                 ".read=%p, .prog=%p, .erase=%p, .sync=%p}, "
                 "%p {.code_size=%"PRIu32", "
                 ".erase_size=%"PRIu32", .erase_count=%"PRIu32", "
-                ".buffer=%p})",
+                ".buffer=%p, .path=\"%s\"})",
             (void*)cfg, cfg->context,
             (void*)(uintptr_t)cfg->read, (void*)(uintptr_t)cfg->prog,
             (void*)(uintptr_t)cfg->erase, (void*)(uintptr_t)cfg->sync,
             (void*)bdcfg,
             bdcfg->code_size, bdcfg->erase_size,
-            bdcfg->erase_count, bdcfg->buffer);
+            bdcfg->erase_count, bdcfg->buffer,
+            (bdcfg->path) ? bdcfg->path : "");
     ramrsbd_t *bd = cfg->context;
     bd->cfg = bdcfg;
+    bd->fd = -1;
 
     // The from code size to message size is a bit complicated, so let's make
     // sure things are configured correctly
@@ -41,23 +348,139 @@ int ramrsbd_create(const struct lfs_config *cfg,
     // to at most 255 byte codewords
     LFS_ASSERT(bd->cfg->code_size <= 255);
 
+    // Make sure the layout is one we know about
+    LFS_ASSERT(bd->cfg->layout == RAMRSBD_LAYOUT_INTERLEAVED
+            || bd->cfg->layout == RAMRSBD_LAYOUT_OOB);
+
+    // Make sure the codec is one we know about
+    LFS_ASSERT(bd->cfg->codec == RAMRSBD_CODEC_RS
+            || bd->cfg->codec == RAMRSBD_CODEC_BCH);
+
+    // Binary BCH codewords are bit strings, so they are limited to at most
+    // 255 bits, and we don't support ecc levels
+    LFS_ASSERT(bd->cfg->codec != RAMRSBD_CODEC_BCH
+            || (8*bd->cfg->code_size <= 255
+                && bd->cfg->ecc_level_count == 0));
+
+    // The bitsliced encoder only knows Reed-Solomon
+    LFS_ASSERT(bd->cfg->codec != RAMRSBD_CODEC_BCH
+            || bd->cfg->bitslice_threshold == 0);
+
     // Make sure the requested error correction is possible
     LFS_ASSERT(bd->cfg->error_correction <= 0
-            || (lfs_size_t)bd->cfg->error_correction <= bd->cfg->ecc_size/2);
+            || (lfs_size_t)bd->cfg->error_correction
+                <= ((bd->cfg->codec == RAMRSBD_CODEC_BCH)
+                    ? bd->cfg->ecc_size
+                    : bd->cfg->ecc_size/2));
+
+    // Read-ahead must be aligned to reads
+    LFS_ASSERT(bd->cfg->readahead_size % cfg->read_size == 0);
+
+    // worker threads need threads
+#ifndef RAMRSBD_YES_THREADS
+    LFS_ASSERT(bd->cfg->worker_count == 0);
+#endif
+
+    // a file-backed buffer needs mmap
+#ifndef RAMRSBD_YES_MMAP
+    LFS_ASSERT(!bd->cfg->path);
+#endif
+    LFS_ASSERT(!bd->cfg->path || !bd->cfg->buffer);
+
+    // a precomputed plan must cover our codewords
+    LFS_ASSERT(!bd->cfg->plan
+            || bd->cfg->plan->size >= ramrsbd_plan_size(bd));
+
+    // precompute where codewords live in each erase block
+    if (bd->cfg->layout == RAMRSBD_LAYOUT_OOB) {
+        // messages are contiguous, and ecc lives after all messages in
+        // the erase block
+        bd->m_stride = bd->cfg->code_size-bd->cfg->ecc_size;
+        bd->e_off = (bd->cfg->erase_size/bd->cfg->code_size)
+                * (bd->cfg->code_size-bd->cfg->ecc_size);
+        bd->e_stride = bd->cfg->ecc_size;
+    } else {
+        // ecc follows the message
+        bd->m_stride = bd->cfg->code_size;
+        bd->e_off = bd->cfg->code_size-bd->cfg->ecc_size;
+        bd->e_stride = bd->cfg->code_size;
+    }
+
+    // copy-on-write/sparse blocks are allocated separately
+    LFS_ASSERT(!(bd->cfg->copy_on_write || bd->cfg->sparse)
+            || (!bd->cfg->buffer && !bd->cfg->path));
+
+    // ecc levels must be increasing, and aren't persisted, so can't be
+    // mixed with file-backed buffers
+    LFS_ASSERT(bd->cfg->ecc_level_count < 255);
+    for (lfs_size_t i = 0; i < bd->cfg->ecc_level_count; i++) {
+        LFS_ASSERT(bd->cfg->ecc_levels[i] < bd->cfg->ecc_size);
+        LFS_ASSERT(i == 0
+                || bd->cfg->ecc_levels[i] > bd->cfg->ecc_levels[i-1]);
+    }
+    LFS_ASSERT(!bd->cfg->ecc_level_count || !bd->cfg->path);
 
     // allocate buffer?
-    if (bd->cfg->buffer) {
+    bd->buffer = NULL;
+    bd->blocks = NULL;
+    bd->pool = NULL;
+    if (bd->cfg->sparse) {
+        bd->blocks = lfs_malloc(
+                bd->cfg->erase_count * sizeof(struct ramrsbd_block*));
+        if (!bd->blocks) {
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
+
+        // all blocks start out unallocated
+        for (lfs_block_t i = 0; i < bd->cfg->erase_count; i++) {
+            bd->blocks[i] = NULL;
+        }
+    } else if (bd->cfg->copy_on_write) {
+        bd->blocks = lfs_malloc(
+                bd->cfg->erase_count * sizeof(struct ramrsbd_block*));
+        if (!bd->blocks) {
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
+
+        // all blocks start out sharing a single zeroed block
+        struct ramrsbd_block *b = ramrsbd_block_alloc(bd);
+        if (!b) {
+            lfs_free(bd->blocks);
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
+        b->refs = bd->cfg->erase_count;
+        memset(b->data, 0, bd->cfg->erase_size);
+
+        for (lfs_block_t i = 0; i < bd->cfg->erase_count; i++) {
+            bd->blocks[i] = b;
+        }
+    } else if (bd->cfg->buffer) {
         bd->buffer = bd->cfg->buffer;
+
+        // zero for reproducibility
+        memset(bd->buffer, 0, bd->cfg->erase_size * bd->cfg->erase_count);
     } else {
+#ifdef RAMRSBD_YES_MMAP
+        // mapped memory is already zeroed, or is an existing image
+        int err = ramrsbd_mmap(bd);
+        if (err) {
+            RAMRSBD_TRACE("ramrsbd_create -> %d", err);
+            return err;
+        }
+#else
         bd->buffer = lfs_malloc(bd->cfg->erase_size * bd->cfg->erase_count);
         if (!bd->buffer) {
             RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
             return LFS_ERR_NOMEM;
         }
-    }
 
-    // zero for reproducibility
-    memset(bd->buffer, 0, bd->cfg->erase_size * bd->cfg->erase_count);
+        // zero for reproducibility
+        memset(bd->buffer, 0, bd->cfg->erase_size * bd->cfg->erase_count);
+#endif
+    }
 
     // allocate codeword buffer?
     if (bd->cfg->code_buffer) {
@@ -87,7 +510,7 @@ int ramrsbd_create(const struct lfs_config *cfg,
     if (bd->cfg->s_buffer) {
         bd->s = (uint8_t*)bd->cfg->s_buffer;
     } else {
-        bd->s = lfs_malloc(bd->cfg->ecc_size);
+        bd->s = lfs_malloc(ramrsbd_s_size(bd));
         if (!bd->s) {
             RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
             return LFS_ERR_NOMEM;
@@ -98,7 +521,7 @@ int ramrsbd_create(const struct lfs_config *cfg,
     if (bd->cfg->λ_buffer) {
         bd->λ = (uint8_t*)bd->cfg->λ_buffer;
     } else {
-        bd->λ = lfs_malloc(bd->cfg->ecc_size);
+        bd->λ = lfs_malloc(ramrsbd_s_size(bd));
         if (!bd->s) {
             RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
             return LFS_ERR_NOMEM;
@@ -109,39 +532,250 @@ int ramrsbd_create(const struct lfs_config *cfg,
     if (bd->cfg->ω_buffer) {
         bd->ω = (uint8_t*)bd->cfg->ω_buffer;
     } else {
-        bd->ω = lfs_malloc(bd->cfg->ecc_size);
+        bd->ω = lfs_malloc(ramrsbd_s_size(bd));
         if (!bd->s) {
             RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
             return LFS_ERR_NOMEM;
         }
     }
 
+    // allocate bitsliced encoder buffer?
+    bd->planes = NULL;
+    if (bd->cfg->bitslice_threshold) {
+        if (bd->cfg->bitslice_buffer) {
+            bd->planes = bd->cfg->bitslice_buffer;
+        } else {
+            bd->planes = lfs_malloc(
+                    RAMRSBD_RS_PLANES_SIZE(bd->cfg->ecc_size));
+            if (!bd->planes) {
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+        }
+    }
+
+    // use a precomputed decode plan, or build our own?
+    if (bd->cfg->plan) {
+        bd->plan = *bd->cfg->plan;
+    } else {
+        void *plan_buffer = bd->cfg->plan_buffer;
+        if (!plan_buffer) {
+            plan_buffer = lfs_malloc(
+                    RAMRSBD_RS_PLAN_SIZE(ramrsbd_plan_size(bd)));
+            if (!plan_buffer) {
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+        }
+
+        ramrsbd_rs_plan(&bd->plan, plan_buffer, ramrsbd_plan_size(bd));
+    }
+
+    // calculate generator polynomial?
     if (!bd->cfg->p) {
-        // calculate generator polynomial
-        //
-        // P(x) = prod_i^n-1 (x - g^i)
-        //
-        // the important property of P(x) is that it evaluates to 0
-        // at every x=g^i for i < n
-        //
-        // normally P(x) needs n+1 terms, but the leading term is
-        // always 1, so we can make it implicit
-        //
+        if (bd->cfg->codec == RAMRSBD_CODEC_BCH) {
+            ramrsbd_bch_p(bd->p, bd->cfg->ecc_size);
+        } else {
+            ramrsbd_rs_p(bd->p, bd->cfg->ecc_size);
+        }
+    }
+
+    // allocate ecc level buffer?
+    bd->levels = NULL;
+    bd->level_errors = NULL;
+    bd->level_p = NULL;
+    if (bd->cfg->ecc_level_count > 0) {
+        lfs_size_t level_p_size = 0;
+        for (lfs_size_t i = 0; i < bd->cfg->ecc_level_count; i++) {
+            level_p_size += bd->cfg->ecc_levels[i];
+        }
+
+        if (bd->cfg->level_buffer) {
+            bd->levels = bd->cfg->level_buffer;
+        } else {
+            bd->levels = lfs_malloc(2*bd->cfg->erase_count + level_p_size);
+            if (!bd->levels) {
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+        }
+        bd->level_errors = bd->levels + bd->cfg->erase_count;
+        bd->level_p = bd->level_errors + bd->cfg->erase_count;
+
+        // all blocks start at the weakest level
+        memset(bd->levels, 0, 2*bd->cfg->erase_count);
+
+        // calculate generator polynomials for each level
+        uint8_t *level_p = bd->level_p;
+        for (lfs_size_t i = 0; i < bd->cfg->ecc_level_count; i++) {
+            ramrsbd_rs_p(level_p, bd->cfg->ecc_levels[i]);
+            level_p += bd->cfg->ecc_levels[i];
+        }
+    }
+
+    // allocate queue buffer?
+    if (bd->cfg->queue_buffer) {
+        bd->queue = bd->cfg->queue_buffer;
+    } else {
+        bd->queue = lfs_malloc(
+                ramrsbd_queue_size(bd) * sizeof(struct ramrsbd_req*));
+        if (!bd->queue) {
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
+    }
+    bd->queue_count = 0;
+
+    // allocate fault injection state?
+    bd->fault_wear = NULL;
+    bd->fault_time = NULL;
+    if (bd->cfg->faults) {
+        if (bd->cfg->faults->buffer) {
+            bd->fault_wear = bd->cfg->faults->buffer;
+        } else {
+            bd->fault_wear = lfs_malloc(
+                    2*bd->cfg->erase_count * sizeof(uint32_t));
+            if (!bd->fault_wear) {
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+        }
+        bd->fault_time = bd->fault_wear + bd->cfg->erase_count;
+
+        // all blocks start unworn at tick 0
+        memset(bd->fault_wear, 0,
+                2*bd->cfg->erase_count * sizeof(uint32_t));
+    }
+    bd->fault_clock = 0;
+    bd->fault_ops = 0;
+
+    // allocate read-ahead buffer?
+    bd->ra_buffer[0] = NULL;
+    bd->ra_buffer[1] = NULL;
+    if (bd->cfg->readahead_size) {
+        if (bd->cfg->readahead_buffer) {
+            bd->ra_buffer[0] = bd->cfg->readahead_buffer;
+        } else {
+            bd->ra_buffer[0] = lfs_malloc(2*bd->cfg->readahead_size);
+            if (!bd->ra_buffer[0]) {
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+        }
+        bd->ra_buffer[1] = bd->ra_buffer[0] + bd->cfg->readahead_size;
+    }
+    bd->ra_req.done = true;
+    bd->ra_block = -1;
+    bd->ra_off = 0;
+    bd->ra_size = 0;
+    bd->ra_last_block = -1;
+    bd->ra_last_off = 0;
+    bd->ra_gen = 0;
+    bd->ra_req_gen = 0;
+
+    // allocate dirty parity buffer?
+    bd->dirty = NULL;
+    bd->dirty_count = 0;
+    if (bd->cfg->write_back) {
+        lfs_size_t dirty_size = (bd->cfg->erase_count
+                    * (bd->cfg->erase_size/bd->cfg->code_size)
+                + 7) / 8;
+        if (bd->cfg->dirty_buffer) {
+            bd->dirty = bd->cfg->dirty_buffer;
+        } else {
+            bd->dirty = lfs_malloc(dirty_size);
+            if (!bd->dirty) {
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+        }
+
+        // everything starts out clean
+        memset(bd->dirty, 0, dirty_size);
+    }
+    bd->flush_req.done = true;
+    bd->flush_block = 0;
+
+    // start recording?
+    bd->record = NULL;
+    if (bd->cfg->record_path) {
+        bd->record = fopen(bd->cfg->record_path, "wb");
+        if (!bd->record) {
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_IO);
+            return LFS_ERR_IO;
+        }
+
+        // write our magic and geometry
+        uint8_t header[8+4*4];
+        memcpy(header, RAMRSBD_RECORD_MAGIC, 8);
+        ramrsbd_record_le32(&header[8],  cfg->read_size);
+        ramrsbd_record_le32(&header[12], cfg->prog_size);
+        ramrsbd_record_le32(&header[16], cfg->block_size);
+        ramrsbd_record_le32(&header[20], cfg->block_count);
+        if (fwrite(header, 1, sizeof(header), bd->record)
+                != sizeof(header)) {
+            fclose(bd->record);
+            bd->record = NULL;
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_IO);
+            return LFS_ERR_IO;
+        }
+    }
 
-        // let P(x) = 1
-        memset(bd->p, 0, bd->cfg->ecc_size);
-        bd->p[bd->cfg->ecc_size-1] = 1;
+#ifdef RAMRSBD_YES_THREADS
+    // start any worker threads
+    pthread_mutex_init(&bd->lock, NULL);
+    pthread_cond_init(&bd->work_cond, NULL);
+    pthread_cond_init(&bd->done_cond, NULL);
+    bd->stopping = false;
+    bd->workers = NULL;
+    if (bd->cfg->worker_count > 0) {
+        bd->workers = lfs_malloc(
+                bd->cfg->worker_count * sizeof(struct ramrsbd_worker));
+        if (!bd->workers) {
+            RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
 
-        for (lfs_size_t i = 0; i < bd->cfg->ecc_size; i++) {
-            // let R(x) = x - g^i
-            uint8_t r[2] = {1, ramrsbd_gf_pow(RAMRSBD_GF_G, i)};
+        for (lfs_size_t i = 0; i < bd->cfg->worker_count; i++) {
+            struct ramrsbd_worker *worker = &bd->workers[i];
+            worker->bd = bd;
+
+            // each worker needs its own scratch space
+            uint8_t *scratch = lfs_malloc(
+                    bd->cfg->code_size + 3*ramrsbd_s_size(bd));
+            if (!scratch) {
+                ramrsbd_stop(bd, i);
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
+            worker->scratch.c = scratch;
+            worker->scratch.s = worker->scratch.c + bd->cfg->code_size;
+            worker->scratch.λ = worker->scratch.s + ramrsbd_s_size(bd);
+            worker->scratch.ω = worker->scratch.λ + ramrsbd_s_size(bd);
+
+            worker->scratch.planes = NULL;
+            if (bd->cfg->bitslice_threshold) {
+                worker->scratch.planes = lfs_malloc(
+                        RAMRSBD_RS_PLANES_SIZE(bd->cfg->ecc_size));
+                if (!worker->scratch.planes) {
+                    lfs_free(scratch);
+                    ramrsbd_stop(bd, i);
+                    RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                    return LFS_ERR_NOMEM;
+                }
+            }
 
-            // let P(x) = P(x) * R(x)
-            ramrsbd_gf_p_mul(
-                    bd->p, bd->cfg->ecc_size,
-                    r, 2);
+            if (pthread_create(&worker->thread, NULL,
+                    ramrsbd_work, worker) != 0) {
+                lfs_free(worker->scratch.planes);
+                lfs_free(scratch);
+                ramrsbd_stop(bd, i);
+                RAMRSBD_TRACE("ramrsbd_create -> %d", LFS_ERR_NOMEM);
+                return LFS_ERR_NOMEM;
+            }
         }
     }
+#endif
 
     RAMRSBD_TRACE("ramrsbd_create -> %d", 0);
     return 0;
@@ -149,10 +783,62 @@ int ramrsbd_create(const struct lfs_config *cfg,
 
 int ramrsbd_destroy(const struct lfs_config *cfg) {
     RAMRSBD_TRACE("ramrsbd_destroy(%p)", (void*)cfg);
-    // clean up memory
     ramrsbd_t *bd = cfg->context;
-    if (!bd->cfg->buffer) {
+
+    // finish any queued requests
+    ramrsbd_lock(bd);
+    while (bd->queue_count > 0) {
+        ramrsbd_progress(bd);
+    }
+    ramrsbd_unlock(bd);
+
+    // finish recording
+    int err = 0;
+    if (bd->record) {
+        if (fclose(bd->record) != 0) {
+            err = LFS_ERR_IO;
+        }
+    }
+
+#ifdef RAMRSBD_YES_THREADS
+    // stop any worker threads
+    ramrsbd_stop(bd, bd->cfg->worker_count);
+    lfs_free(bd->workers);
+    pthread_cond_destroy(&bd->done_cond);
+    pthread_cond_destroy(&bd->work_cond);
+    pthread_mutex_destroy(&bd->lock);
+#endif
+
+    // compute any deferred parity, so file-backed buffers are consistent
+    if (bd->cfg->write_back && bd->cfg->path) {
+        struct ramrsbd_scratch scratch = ramrsbd_scratch(bd);
+        ramrsbd_flush_all(bd, &scratch);
+    }
+
+    // clean up memory
+    if (bd->blocks) {
+        for (lfs_block_t i = 0; i < bd->cfg->erase_count; i++) {
+            if (bd->blocks[i]) {
+                ramrsbd_block_decref(bd->blocks[i]);
+            }
+        }
+        lfs_free(bd->blocks);
+
+        while (bd->pool) {
+            struct ramrsbd_block *b = bd->pool;
+            bd->pool = b->next;
+            lfs_free(b);
+        }
+    } else if (!bd->cfg->buffer) {
+#ifdef RAMRSBD_YES_MMAP
+        munmap(bd->buffer,
+                (size_t)bd->cfg->erase_size * bd->cfg->erase_count);
+        if (bd->fd >= 0) {
+            close(bd->fd);
+        }
+#else
         lfs_free(bd->buffer);
+#endif
     }
     if (!bd->cfg->code_buffer) {
         lfs_free(bd->c);
@@ -160,6 +846,9 @@ int ramrsbd_destroy(const struct lfs_config *cfg) {
     if (!bd->cfg->p && !bd->cfg->p_buffer) {
         lfs_free(bd->p);
     }
+    if (!bd->cfg->plan && !bd->cfg->plan_buffer) {
+        lfs_free((uint8_t*)bd->plan.x);
+    }
     if (!bd->cfg->s_buffer) {
         lfs_free(bd->s);
     }
@@ -169,356 +858,1350 @@ int ramrsbd_destroy(const struct lfs_config *cfg) {
     if (!bd->cfg->ω_buffer) {
         lfs_free(bd->ω);
     }
-    RAMRSBD_TRACE("ramrsbd_destroy -> %d", 0);
-    return 0;
+    if (bd->cfg->bitslice_threshold && !bd->cfg->bitslice_buffer) {
+        lfs_free(bd->planes);
+    }
+    if (!bd->cfg->queue_buffer) {
+        lfs_free(bd->queue);
+    }
+    if (bd->cfg->ecc_level_count > 0 && !bd->cfg->level_buffer) {
+        lfs_free(bd->levels);
+    }
+    if (bd->cfg->faults && !bd->cfg->faults->buffer) {
+        lfs_free(bd->fault_wear);
+    }
+    if (bd->cfg->write_back && !bd->cfg->dirty_buffer) {
+        lfs_free(bd->dirty);
+    }
+    if (bd->cfg->readahead_size && !bd->cfg->readahead_buffer) {
+        // our read-ahead buffers may have been swapped
+        lfs_free((bd->ra_buffer[0] < bd->ra_buffer[1])
+                ? bd->ra_buffer[0]
+                : bd->ra_buffer[1]);
+    }
+    RAMRSBD_TRACE("ramrsbd_destroy -> %d", err);
+    return err;
 }
 
-// find the set of syndromes S for a codeword C(x)
-//
-// S_i = C(g^i)
-//
-// if our codeword contains no errors, these should all be zero,
-// otherwise they tell us information about the errors,
-// S_i = sum_j Y_j X_j^i where j is an error
-//
-// also returns true if zero for convenience
-static bool ramrsbd_find_s(
-        uint8_t *s, lfs_size_t s_size,
-        const uint8_t *c, lfs_size_t c_size) {
-    // calculate syndromes
-    bool s_zero = true;
-    for (lfs_size_t i = 0; i < s_size; i++) {
-        // let S_i = C(g^i)
-        s[i] = ramrsbd_gf_p_eval(
-                c, c_size,
-                ramrsbd_gf_pow(RAMRSBD_GF_G, s_size-1-i));
 
-        // keep track of if we have any non-zero syndromes
-        if (s[i] != 0) {
-            s_zero = false;
-        }
+// find the ecc size and generator polynomial for a block's ecc level
+static lfs_size_t ramrsbd_level(ramrsbd_t *bd, lfs_block_t block,
+        const uint8_t **p) {
+    if (bd->cfg->ecc_level_count == 0
+            || bd->levels[block] == bd->cfg->ecc_level_count) {
+        *p = bd->p;
+        return bd->cfg->ecc_size;
     }
 
-    return s_zero;
+    // generator polynomials are stored contiguously
+    const uint8_t *level_p = bd->level_p;
+    for (lfs_size_t i = 0; i < bd->levels[block]; i++) {
+        level_p += bd->cfg->ecc_levels[i];
+    }
+    *p = level_p;
+    return bd->cfg->ecc_levels[bd->levels[block]];
 }
 
-// find the error-locator polynomial Λ(x), given a set of syndromes S,
-// with C providing scratch space for interim math
-//
-// Λ(x) = prod_j (1 - X_j x) = 1 + sum_k=1^e Λ_k x^k
-//
-// where Λ(X_j^-1)=0 if j is an error and Λ(0)=1
-//
-// also returns the number of errors for convenience
-static lfs_size_t ramrsbd_find_λ(
-        uint8_t *λ, lfs_size_t λ_size,
-        uint8_t *c, lfs_size_t c_size,
-        const uint8_t *s, lfs_size_t s_size) {
-    LFS_ASSERT(c_size == λ_size);
-    LFS_ASSERT(s_size == λ_size);
-
-    // iteratively find the error-locator using Berlekamp-Massey
-    //
-    // this treats Λ as an LFSR we need to solve in GF(256)
-    //
 
-    // guess an error-locator LFSR
-    //
-    // let e = 0    // guessed LFSR size/number of errors
-    // let Λ(i) = 1 // current LFSR guess
-    // let C(i) = 1 // best LFSR so far
-    //
-    lfs_size_t e = 0;
-    memset(λ, 0, λ_size-1);
-    λ[λ_size-1] = 1;
-    memset(c, 0, c_size-1);
-    c[c_size-1] = 1;
-
-    // iterate through symbols
-    for (lfs_size_t n = 0; n < s_size; n++) {
-        // shift C(i) = C(i-1)
-        memmove(c, c+1, c_size-1);
-        c[c_size-1] = 0;
-
-        // calculate next symbol discrepancy
-        //
-        // let d = S_n - Λ(n) = S_n - sum_k=1^e Λ_k S_n-k
-        //
-        uint8_t d = s[s_size-1-n];
-        for (lfs_size_t k = 1; k <= e; k++) {
-            d ^= ramrsbd_gf_mul(
-                    λ[λ_size-1-k],
-                    s[s_size-1-(n-k)]);
-        }
-
-        // found discrepancy?
-        if (d != 0) {
-            // let Λ(i) = Λ(i) - d C(i)
-            ramrsbd_gf_p_xors(
-                    λ, λ_size,
-                    d,
-                    c, c_size);
-
-            // not enough errors for discrepancy?
-            if (n >= 2*e) {
-                // update the number of errors
-                e = n+1 - e;
-
-                // save best LFSR for later
-                //
-                // this should be C(i) = d^-1 Λ(i), but before we
-                // modified Λ(i) = Λ(i) - d C(i), fortunately we can just
-                // undo the modification to avoid needing another buffer:
-                //
-                // let C(i) = d^-1 (Λ(i) + d C(i))
-                //          = C(i) + d^-1 Λ(i)
-                //
-                ramrsbd_gf_p_xors(
-                        c, c_size,
-                        ramrsbd_gf_div(1, d),
-                        λ, λ_size);
-            }
-        }
-    }
+// fault injection
 
-    return e;
+// a simple integer hash, faults are derived from this so they are
+// deterministic without needing to store anything per-bit
+static uint32_t ramrsbd_hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
 }
 
-// find the error-evaluator polynomial Ω(x), given a syndrome
-// polynomial S(x) and an error-locator polynomial Λ(x)
-//
-// Ω(x) = S(x) Λ(x) mod x^n
-//
-// this indirectly gives us our error-magnitudes Y_j for a given X_j,
-// Ω(X_j^-1) = Y_j X_j Λ'(X_j^-1), if j is an error
-//
-static void ramrsbd_find_ω(
-        uint8_t *ω, lfs_size_t ω_size,
-        const uint8_t *s, lfs_size_t s_size,
-        const uint8_t *λ, lfs_size_t λ_size) {
-    LFS_ASSERT(ω_size == s_size);
-    LFS_ASSERT(ω_size == λ_size);
-
-    // let Ω(x) = S(x) Λ(x) mod x^n
-    //
-    // note that the mod is really just truncating the array, which
-    // ramrsbd_gf_p_mul does implicitly if the array is too small
-    //
-    memcpy(ω, s, s_size);
-    ramrsbd_gf_p_mul(
-            ω, ω_size,
-            λ, λ_size);
+// hash a kind of fault at a location in codeword space
+static uint32_t ramrsbd_fault_hash(ramrsbd_t *bd,
+        uint32_t kind, lfs_block_t block, lfs_off_t off) {
+    return ramrsbd_hash(
+            ramrsbd_hash(
+                ramrsbd_hash(bd->cfg->faults->seed ^ kind)
+                ^ block)
+            ^ off);
 }
 
-int ramrsbd_read(const struct lfs_config *cfg, lfs_block_t block,
-        lfs_off_t off, void *buffer, lfs_size_t size) {
-    RAMRSBD_TRACE("ramrsbd_read(%p, "
-                "0x%"PRIx32", %"PRIu32", %p, %"PRIu32")",
-            (void*)cfg, block, off, buffer, size);
-    ramrsbd_t *bd = cfg->context;
+// scale a rate, saturating at 100%
+static uint32_t ramrsbd_fault_scale(uint64_t rate, uint64_t scale) {
+    if (scale > 0 && rate > UINT32_MAX/scale) {
+        return UINT32_MAX;
+    }
+    return rate*scale;
+}
 
-    // check if read is valid
-    LFS_ASSERT(block < cfg->block_count);
-    LFS_ASSERT(off  % cfg->read_size == 0);
-    LFS_ASSERT(size % cfg->read_size == 0);
-    LFS_ASSERT(off+size <= cfg->block_size);
+// current fault clock, note the clock may be advanced by other threads
+static uint32_t ramrsbd_fault_now(ramrsbd_t *bd) {
+    ramrsbd_lock(bd);
+    uint32_t now = bd->fault_clock;
+    ramrsbd_unlock(bd);
+    return now;
+}
 
-    // work on one codeword at a time
-    uint8_t *buffer_ = buffer;
-    while (size > 0) {
-        // map off to codeword space
-        lfs_off_t off_
-                = (off / (bd->cfg->code_size-bd->cfg->ecc_size))
-                * bd->cfg->code_size;
+// apply any faults to a codeword C(x), given the codeword's offset in
+// codeword space
+static void ramrsbd_fault(ramrsbd_t *bd, uint32_t now,
+        lfs_block_t block, lfs_off_t off, uint8_t *c) {
+    const struct ramrsbd_faults *faults = bd->cfg->faults;
+    uint32_t age = now - bd->fault_time[block];
 
-        // read codeword
-        memcpy(bd->c,
-                &bd->buffer[block*bd->cfg->erase_size + off_],
-                bd->cfg->code_size);
-
-        // calculate syndromes
-        bool s_zero = ramrsbd_find_s(
-                bd->s, bd->cfg->ecc_size,
-                bd->c, bd->cfg->code_size);
-
-        // non-zero syndromes? errors are present, attempt to correct
-        if (!s_zero) {
-            // find the error-locator polynomial Λ(x)
-            lfs_size_t n = ramrsbd_find_λ(
-                    bd->λ, bd->cfg->ecc_size,
-                    // use Ω(x) as scratch space
-                    bd->ω, bd->cfg->ecc_size,
-                    bd->s, bd->cfg->ecc_size);
-
-            // too many errors?
-            if (n > bd->cfg->ecc_size/2
-                    || (bd->cfg->error_correction
-                        && (lfs_ssize_t)n > bd->cfg->error_correction)) {
-                LFS_WARN("Found uncorrectable ramrsbd errors "
-                        "0x%"PRIx32".%"PRIx32" %"PRIu32" "
-                        "(%"PRId32" > %"PRId32")",
-                        block, off_,
-                        bd->cfg->code_size - bd->cfg->ecc_size,
-                        n,
-                        (bd->cfg->error_correction)
-                            ? bd->cfg->error_correction
-                            : (lfs_ssize_t)(bd->cfg->ecc_size/2));
-                return LFS_ERR_CORRUPT;
+    // bit errors accumulate with age, faster in worn blocks
+    //
+    // to avoid a hash per bit, we approximate this with at most one bit
+    // error per byte, which is close enough for small rates
+    uint32_t byte_rate = ramrsbd_fault_scale(
+            faults->bit_error_rate
+                + (uint64_t)faults->wear_rate*bd->fault_wear[block],
+            8*(uint64_t)age);
+    if (byte_rate > 0) {
+        for (lfs_size_t j = 0; j < bd->cfg->code_size; j++) {
+            uint32_t h = ramrsbd_fault_hash(bd, 1, block, off+j);
+            if (h < byte_rate) {
+                c[j] ^= 1 << (ramrsbd_hash(h) % 8);
             }
+        }
+    }
 
-            // find the error evaluator polynomial Ω(x)
-            ramrsbd_find_ω(
-                    bd->ω, bd->cfg->ecc_size,
-                    bd->s, bd->cfg->ecc_size,
-                    bd->λ, bd->cfg->ecc_size);
-
-            // brute force search for error locations, this is any
-            // location X_j=g^j where X_j^-1 is a root of our
-            // error-locator, Λ(X_j^-1) = 0
-            for (lfs_size_t j = 0; j < bd->cfg->code_size; j++) {
-                // map the error location to the multiplicative ring
-                //
-                // let X_j = g^j
-                //
-                uint8_t x_j = ramrsbd_gf_pow(
-                        RAMRSBD_GF_G,
-                        bd->cfg->code_size-1-j);
-                uint8_t x_j_ = ramrsbd_gf_div(1, x_j);
-
-                // is X_j a root of our error-locator?
-                //
-                // does Λ(X_j^-1) = 0?
-                //
-                if (ramrsbd_gf_p_eval(
-                            bd->λ, bd->cfg->ecc_size,
-                            x_j_)
-                        != 0) {
-                    continue;
-                }
-
-                // found an error location, now find its magnitude
-                //
-                //                Ω(X_j^-1)
-                // let Y_j = X_j ----------
-                //               Λ'(X_j^-1)
-                //
-                uint8_t y_j = ramrsbd_gf_mul(
-                        x_j,
-                        ramrsbd_gf_div(
-                            ramrsbd_gf_p_eval(
-                                bd->ω, bd->cfg->ecc_size,
-                                x_j_),
-                            ramrsbd_gf_p_deval(
-                                bd->λ, bd->cfg->ecc_size,
-                                x_j_)));
-
-                // found error location and magnitude, now we can fix it!
-                bd->c[j] ^= y_j;
+    // burst errors flip a run of consecutive bits
+    uint32_t burst_rate = ramrsbd_fault_scale(faults->burst_rate, age);
+    if (burst_rate > 0 && faults->burst_size > 0) {
+        uint32_t h = ramrsbd_fault_hash(bd, 2, block, off);
+        if (h < burst_rate) {
+            lfs_size_t bit = ramrsbd_hash(h) % (8*bd->cfg->code_size);
+            for (lfs_size_t i = 0;
+                    i < faults->burst_size && bit+i < 8*bd->cfg->code_size;
+                    i++) {
+                c[(bit+i)/8] ^= 0x80 >> ((bit+i)%8);
             }
+        }
+    }
 
-            // calculate syndromes again to make sure we found all errors
-            bool s_zero = ramrsbd_find_s(
-                    bd->s, bd->cfg->ecc_size,
-                    bd->c, bd->cfg->code_size);
-            if (!s_zero) {
-                LFS_WARN("Found uncorrectable ramrsbd errors "
-                        "0x%"PRIx32".%"PRIx32" %"PRIu32" "
-                        "(s != 0)",
-                        block, off_,
-                        bd->cfg->code_size - bd->cfg->ecc_size);
-                return LFS_ERR_CORRUPT;
+    // stuck bytes are permanent, and override any other faults
+    if (faults->stuck_rate > 0) {
+        for (lfs_size_t j = 0; j < bd->cfg->code_size; j++) {
+            uint32_t h = ramrsbd_fault_hash(bd, 3, block, off+j);
+            if (h < faults->stuck_rate) {
+                c[j] = (ramrsbd_hash(h) & 1) ? 0xff : 0x00;
             }
-
-            LFS_DEBUG("Found %"PRId32" correctable ramcrc32bd errors "
-                    "0x%"PRIx32".%"PRIx32" %"PRIu32,
-                    n,
-                    block, off_,
-                    bd->cfg->code_size - bd->cfg->ecc_size);
         }
+    }
+}
 
-        // copy the data part of our codeword
-        memcpy(buffer_, bd->c, bd->cfg->code_size-bd->cfg->ecc_size);
 
-        off += bd->cfg->code_size-bd->cfg->ecc_size;
-        buffer_ += bd->cfg->code_size-bd->cfg->ecc_size;
-        size -= bd->cfg->code_size-bd->cfg->ecc_size;
-    }
+// deferred parity
 
-    RAMRSBD_TRACE("ramrsbd_read -> %d", 0);
-    return 0;
+// find a codeword's dirty bit, given an offset in message space
+static lfs_size_t ramrsbd_dirty_bit(ramrsbd_t *bd,
+        lfs_block_t block, lfs_off_t off) {
+    return block*(bd->cfg->erase_size/bd->cfg->code_size)
+            + off/(bd->cfg->code_size-bd->cfg->ecc_size);
 }
 
-int ramrsbd_prog(const struct lfs_config *cfg, lfs_block_t block,
-        lfs_off_t off, const void *buffer, lfs_size_t size) {
-    RAMRSBD_TRACE("ramrsbd_prog(%p, "
-                "0x%"PRIx32", %"PRIu32", %p, %"PRIu32")",
-            (void*)cfg, block, off, buffer, size);
-    ramrsbd_t *bd = cfg->context;
+// is a codeword's parity dirty? must be called with the lock held
+static bool ramrsbd_isdirty(ramrsbd_t *bd,
+        lfs_block_t block, lfs_off_t off) {
+    lfs_size_t i = ramrsbd_dirty_bit(bd, block, off);
+    return bd->dirty[i/8] & (1 << (i%8));
+}
 
-    // check if prog is valid
-    LFS_ASSERT(block < cfg->block_count);
-    LFS_ASSERT(off  % cfg->prog_size == 0);
-    LFS_ASSERT(size % cfg->prog_size == 0);
-    LFS_ASSERT(off+size <= cfg->block_size);
+// mark a codeword's parity as dirty/clean, must be called with the lock
+// held
+static void ramrsbd_setdirty(ramrsbd_t *bd,
+        lfs_block_t block, lfs_off_t off, bool dirty) {
+    lfs_size_t i = ramrsbd_dirty_bit(bd, block, off);
+    bool dirty_ = bd->dirty[i/8] & (1 << (i%8));
+    if (dirty && !dirty_) {
+        bd->dirty[i/8] |= 1 << (i%8);
+        bd->dirty_count += 1;
+    } else if (!dirty && dirty_) {
+        bd->dirty[i/8] &= ~(1 << (i%8));
+        bd->dirty_count -= 1;
+    }
+}
 
-    // work on one codeword at a time
-    const uint8_t *buffer_ = buffer;
-    while (size > 0) {
-        // map off to codeword space
-        lfs_off_t off_
-                = (off / (bd->cfg->code_size-bd->cfg->ecc_size))
-                * bd->cfg->code_size;
-
-        // calculate ecc of size n
-        //
-        // let C(x) = M(x) x^n + (M(x) x^n mod P(x))
-        //
-        // note this makes C(x) divisible by P(x)
-        //
-        memset(bd->c, 0, bd->cfg->code_size);
-        memcpy(bd->c, buffer_, bd->cfg->code_size-bd->cfg->ecc_size);
-        ramrsbd_gf_p_divmod1(
-                bd->c, bd->cfg->code_size,
-                bd->p, bd->cfg->ecc_size);
-
-        // the divmod clobbers M(x), so we need to copy M(x) again
-        memcpy(bd->c, buffer_, bd->cfg->code_size-bd->cfg->ecc_size);
-
-        // program our codeword
-        memcpy(&bd->buffer[block*bd->cfg->erase_size + off_],
-                bd->c,
-                bd->cfg->code_size);
+// find the next block with dirty parity, starting at block and wrapping
+// around, must be called with the lock held
+//
+// returns -1 if everything is clean
+static lfs_block_t ramrsbd_dirty_next(ramrsbd_t *bd, lfs_block_t block) {
+    if (bd->dirty_count == 0) {
+        return -1;
+    }
 
-        off += bd->cfg->code_size-bd->cfg->ecc_size;
-        buffer_ += bd->cfg->code_size-bd->cfg->ecc_size;
-        size -= bd->cfg->code_size-bd->cfg->ecc_size;
+    lfs_size_t per_block = bd->cfg->erase_size/bd->cfg->code_size;
+    lfs_size_t count = bd->cfg->erase_count * per_block;
+    for (lfs_size_t j = 0; j < count; j++) {
+        lfs_size_t i = (block*per_block + j) % count;
+        // skip clean bytes quickly
+        if (i % 8 == 0 && i+8 <= count && bd->dirty[i/8] == 0) {
+            j += 7;
+            continue;
+        }
+
+        if (bd->dirty[i/8] & (1 << (i%8))) {
+            return i / per_block;
+        }
     }
 
-    RAMRSBD_TRACE("ramrsbd_prog -> %d", 0);
-    return 0;
+    return -1;
 }
 
-int ramrsbd_erase(const struct lfs_config *cfg, lfs_block_t block) {
-    RAMRSBD_TRACE("ramrsbd_erase(%p, 0x%"PRIx32" (%"PRIu32"))",
-            (void*)cfg, block, ((ramrsbd_t*)cfg->context)->cfg->erase_size);
+// compute parity for a run of codewords from their stored messages
+static void ramrsbd_encode_(ramrsbd_t *bd, struct ramrsbd_scratch *scratch,
+        lfs_block_t block, lfs_off_t off, lfs_size_t count) {
+    // find our block's ecc level, note weaker ecc levels just leave the
+    // end of our ecc unused
+    const uint8_t *p;
+    lfs_size_t ecc_size = ramrsbd_level(bd, block, &p);
+
+    // binary BCH codec, if configured
+    ramrsbd_bch_t bch = {
+        .code_size = bd->cfg->code_size,
+        .ecc_size = bd->cfg->ecc_size,
+        .p = bd->p,
+    };
+
+    // encode enough codewords at once with our bitsliced encoder?
+    if (bd->cfg->bitslice_threshold
+            && count >= bd->cfg->bitslice_threshold) {
+        ramrsbd_rs_encode_bitsliced(p, ecc_size,
+                ramrsbd_find_m(bd, block, off),
+                bd->cfg->code_size-bd->cfg->ecc_size,
+                bd->m_stride,
+                ramrsbd_find_e(bd, block, off),
+                bd->e_stride,
+                count,
+                scratch->planes);
+        return;
+    }
 
-    // check if erase is valid
-    LFS_ASSERT(block < cfg->block_count);
+    // find our first codeword, after this we can just follow our
+    // strides
+    uint8_t *m = ramrsbd_find_m(bd, block, off);
+    uint8_t *e = ramrsbd_find_e(bd, block, off);
+    for (lfs_size_t i = 0; i < count; i++) {
+        if (bd->cfg->codec == RAMRSBD_CODEC_BCH) {
+            // binary BCH works a bit at a time, so stage our codeword in
+            // our codeword buffer
+            memcpy(scratch->c,
+                    m,
+                    bd->cfg->code_size-bd->cfg->ecc_size);
+            ramrsbd_bch_encode(&bch, scratch->c, 1);
+
+            memcpy(e,
+                    &scratch->c[bd->cfg->code_size-bd->cfg->ecc_size],
+                    bd->cfg->ecc_size);
+        } else {
+            // calculate ecc of size n
+            //
+            // let C(x) = M(x) x^n + (M(x) x^n mod P(x))
+            //
+            // note this makes C(x) divisible by P(x)
+            //
+            // streaming the message means we don't need to stage
+            // M(x) x^n in our codeword buffer, we only need n bytes for
+            // the remainder
+            //
+            ramrsbd_rs_enc_t enc;
+            ramrsbd_rs_enc_init(&enc, p, scratch->c, ecc_size);
+            ramrsbd_rs_enc_update(&enc,
+                    m,
+                    bd->cfg->code_size-bd->cfg->ecc_size);
+            ramrsbd_rs_enc_final(&enc, e);
+        }
 
-    // erase is a noop
-    (void)cfg;
-    (void)block;
+        m += bd->m_stride;
+        e += bd->e_stride;
+    }
+}
 
-    RAMRSBD_TRACE("ramrsbd_erase -> %d", 0);
+// compute any deferred parity in a range of codewords, must be called
+// with the lock held
+static void ramrsbd_flush_(ramrsbd_t *bd, struct ramrsbd_scratch *scratch,
+        lfs_block_t block, lfs_off_t off, lfs_size_t size) {
+    while (size > 0) {
+        // find a run of dirty codewords, so we can encode them in one go
+        lfs_size_t count = 0;
+        while (count*(bd->cfg->code_size-bd->cfg->ecc_size) < size
+                && ramrsbd_isdirty(bd, block,
+                    off + count*(bd->cfg->code_size-bd->cfg->ecc_size))) {
+            ramrsbd_setdirty(bd, block,
+                    off + count*(bd->cfg->code_size-bd->cfg->ecc_size),
+                    false);
+            count += 1;
+        }
+
+        if (count > 0) {
+            ramrsbd_encode_(bd, scratch, block, off, count);
+        } else {
+            // skip clean codewords
+            count = 1;
+        }
+
+        off += count*(bd->cfg->code_size-bd->cfg->ecc_size);
+        size -= count*(bd->cfg->code_size-bd->cfg->ecc_size);
+    }
+}
+
+// compute any deferred parity in a block
+//
+// this takes the lock for each codeword, so other threads can make
+// progress while we work in the background
+static void ramrsbd_flush_block(ramrsbd_t *bd,
+        struct ramrsbd_scratch *scratch, lfs_block_t block) {
+    for (lfs_off_t off = 0;
+            off < (bd->cfg->erase_size/bd->cfg->code_size)
+                * (bd->cfg->code_size-bd->cfg->ecc_size);
+            off += bd->cfg->code_size-bd->cfg->ecc_size) {
+        ramrsbd_lock(bd);
+        ramrsbd_flush_(bd, scratch, block, off,
+                bd->cfg->code_size-bd->cfg->ecc_size);
+        ramrsbd_unlock(bd);
+    }
+}
+
+// compute all deferred parity, must be called with the lock held
+static void ramrsbd_flush_all(ramrsbd_t *bd,
+        struct ramrsbd_scratch *scratch) {
+    lfs_block_t block = ramrsbd_dirty_next(bd, 0);
+    while (block != (lfs_block_t)-1) {
+        ramrsbd_flush_(bd, scratch, block, 0,
+                (bd->cfg->erase_size/bd->cfg->code_size)
+                    * (bd->cfg->code_size-bd->cfg->ecc_size));
+        block = ramrsbd_dirty_next(bd, block);
+    }
+}
+
+
+// decode and read a range of codewords
+static int ramrsbd_read_(ramrsbd_t *bd, struct ramrsbd_scratch *scratch,
+        lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size) {
+    // unallocated sparse blocks are always zeros, no need to decode
+    if (bd->blocks && !bd->blocks[block]) {
+        memset(buffer, 0, size);
+        return 0;
+    }
+
+    // compute any deferred parity first, note other threads may be
+    // reading the same codewords
+    if (bd->cfg->write_back) {
+        ramrsbd_lock(bd);
+        ramrsbd_flush_(bd, scratch, block, off, size);
+        ramrsbd_unlock(bd);
+    }
+
+    // snapshot our fault clock, if we're injecting faults
+    uint32_t now = (bd->cfg->faults) ? ramrsbd_fault_now(bd) : 0;
+
+    // our codec, with our block's ecc level and our thread's scratch
+    // space
+    //
+    // note weaker ecc levels just leave the end of our ecc unused
+    ramrsbd_rs_t rs = {
+        .error_correction = bd->cfg->error_correction,
+        .s = scratch->s,
+        .λ = scratch->λ,
+        .ω = scratch->ω,
+        .plan = &bd->plan,
+    };
+    rs.ecc_size = ramrsbd_level(bd, block, &rs.p);
+    rs.code_size = bd->cfg->code_size-bd->cfg->ecc_size + rs.ecc_size;
+
+    // or binary BCH
+    ramrsbd_bch_t bch = {
+        .code_size = bd->cfg->code_size,
+        .ecc_size = bd->cfg->ecc_size,
+        .error_correction = bd->cfg->error_correction,
+        .p = bd->p,
+        .s = scratch->s,
+        .λ = scratch->λ,
+        .ω = scratch->ω,
+        .plan = &bd->plan,
+    };
+
+    // find our first codeword, after this we can just follow our
+    // strides
+    const uint8_t *m = ramrsbd_find_m(bd, block, off);
+    const uint8_t *e = ramrsbd_find_e(bd, block, off);
+    lfs_off_t code_off = (off / (bd->cfg->code_size-bd->cfg->ecc_size))
+            * bd->cfg->code_size;
+
+    // work on one codeword at a time
+    uint8_t *buffer_ = buffer;
+    while (size > 0) {
+        // read codeword
+        memcpy(scratch->c,
+                m,
+                bd->cfg->code_size-bd->cfg->ecc_size);
+        memcpy(&scratch->c[bd->cfg->code_size-bd->cfg->ecc_size],
+                e,
+                bd->cfg->ecc_size);
+
+        // inject any faults
+        if (bd->cfg->faults) {
+            ramrsbd_fault(bd, now, block, code_off, scratch->c);
+        }
+
+        // decode, correcting any errors
+        int8_t n;
+        int err;
+        if (bd->cfg->codec == RAMRSBD_CODEC_BCH) {
+            err = ramrsbd_bch_decode(&bch, scratch->c, 1, &n);
+        } else {
+            err = ramrsbd_rs_decode(&rs, scratch->c, 1, &n);
+        }
+        if (err) {
+            LFS_WARN("Found uncorrectable ramrsbd errors "
+                    "0x%"PRIx32".%"PRIx32" %"PRIu32,
+                    block, off,
+                    bd->cfg->code_size - bd->cfg->ecc_size);
+            return err;
+        }
+
+        if (n > 0) {
+            LFS_DEBUG("Found %"PRId32" correctable ramrsbd errors "
+                    "0x%"PRIx32".%"PRIx32" %"PRIu32,
+                    (int32_t)n,
+                    block, off,
+                    bd->cfg->code_size - bd->cfg->ecc_size);
+
+            // keep track of errors to pick the block's next ecc level,
+            // note other threads may be reading the same block
+            if (bd->cfg->ecc_level_count > 0) {
+                ramrsbd_lock(bd);
+                bd->level_errors[block] = lfs_max(
+                        bd->level_errors[block],
+                        (uint8_t)n);
+                ramrsbd_unlock(bd);
+            }
+        }
+
+        // copy the data part of our codeword
+        memcpy(buffer_, scratch->c, bd->cfg->code_size-bd->cfg->ecc_size);
+
+        m += bd->m_stride;
+        e += bd->e_stride;
+        code_off += bd->cfg->code_size;
+        off += bd->cfg->code_size-bd->cfg->ecc_size;
+        buffer_ += bd->cfg->code_size-bd->cfg->ecc_size;
+        size -= bd->cfg->code_size-bd->cfg->ecc_size;
+    }
+
+    return 0;
+}
+
+// encode and program a range of codewords
+static int ramrsbd_prog_(ramrsbd_t *bd, struct ramrsbd_scratch *scratch,
+        lfs_block_t block, lfs_off_t off,
+        const void *buffer, lfs_size_t size) {
+    // make sure we're not writing to a shared block
+    int err = ramrsbd_cow(bd, block);
+    if (err) {
+        return err;
+    }
+
+    // program our messages
+    if (bd->cfg->layout == RAMRSBD_LAYOUT_OOB) {
+        // messages are contiguous, so this is a single copy
+        memcpy(ramrsbd_find_m(bd, block, off), buffer, size);
+    } else {
+        const uint8_t *buffer_ = buffer;
+        uint8_t *m = ramrsbd_find_m(bd, block, off);
+        for (lfs_off_t i = 0;
+                i < size;
+                i += bd->cfg->code_size-bd->cfg->ecc_size) {
+            memcpy(m,
+                    &buffer_[i],
+                    bd->cfg->code_size-bd->cfg->ecc_size);
+            m += bd->m_stride;
+        }
+    }
+
+    // defer computing parity?
+    if (bd->cfg->write_back) {
+        ramrsbd_lock(bd);
+        for (lfs_off_t i = 0;
+                i < size;
+                i += bd->cfg->code_size-bd->cfg->ecc_size) {
+            ramrsbd_setdirty(bd, block, off+i, true);
+        }
+        ramrsbd_unlock(bd);
+        return 0;
+    }
+
+    // calculate parity
+    ramrsbd_encode_(bd, scratch, block, off,
+            size / (bd->cfg->code_size-bd->cfg->ecc_size));
+    return 0;
+}
+
+// erase a block
+static int ramrsbd_erase_(ramrsbd_t *bd, lfs_block_t block) {
+    // sparse blocks return to our pool, and read as zeros until progged
+    // again
+    if (bd->cfg->sparse && bd->blocks[block]) {
+        ramrsbd_block_release(bd, bd->blocks[block]);
+        bd->blocks[block] = NULL;
+
+        // which also means there's no parity to compute
+        if (bd->cfg->write_back) {
+            ramrsbd_lock(bd);
+            for (lfs_off_t off = 0;
+                    off < (bd->cfg->erase_size/bd->cfg->code_size)
+                        * (bd->cfg->code_size-bd->cfg->ecc_size);
+                    off += bd->cfg->code_size-bd->cfg->ecc_size) {
+                ramrsbd_setdirty(bd, block, off, false);
+            }
+            ramrsbd_unlock(bd);
+        }
+    }
+
+    // otherwise erase is a noop, but this is our chance to pick a new ecc
+    // level, if reads needed at least half of the current level's
+    // correction capability, move up a level
+    if (bd->cfg->ecc_level_count > 0) {
+        const uint8_t *p;
+        lfs_size_t ecc_size = ramrsbd_level(bd, block, &p);
+        if (bd->levels[block] < bd->cfg->ecc_level_count
+                && bd->level_errors[block] > 0
+                && 2*bd->level_errors[block] >= ecc_size/2) {
+            // old codewords aren't valid at the new level, so zero the
+            // block, zeros are valid at any level
+            if (!bd->cfg->sparse) {
+                int err = ramrsbd_cow(bd, block);
+                if (err) {
+                    return err;
+                }
+                memset(ramrsbd_find_block(bd, block), 0,
+                        bd->cfg->erase_size);
+            }
+            bd->levels[block] += 1;
+
+            LFS_DEBUG("Moved ramrsbd block 0x%"PRIx32" "
+                    "to ecc level %"PRIu32,
+                    block, (uint32_t)bd->levels[block]);
+        }
+        bd->level_errors[block] = 0;
+    }
+
+    // we may also need to track wear and restart the block's fault clock
+    if (bd->cfg->faults) {
+        bd->fault_wear[block] += 1;
+        bd->fault_time[block] = ramrsbd_fault_now(bd);
+    }
+    return 0;
+}
+
+// sync the block device
+static int ramrsbd_sync_(ramrsbd_t *bd, struct ramrsbd_scratch *scratch) {
+    // compute any deferred parity
+    if (bd->cfg->write_back) {
+        ramrsbd_lock(bd);
+        ramrsbd_flush_all(bd, scratch);
+        ramrsbd_unlock(bd);
+    }
+
+#ifdef RAMRSBD_YES_MMAP
+    // flush file-backed buffers to disk
+    if (bd->fd >= 0) {
+        if (msync(bd->buffer,
+                (size_t)bd->cfg->erase_size * bd->cfg->erase_count,
+                MS_SYNC) < 0) {
+            return LFS_ERR_IO;
+        }
+    }
+#endif
+    return 0;
+}
+
+
+// asynchronous request handling
+
+static void ramrsbd_lock(ramrsbd_t *bd) {
+#ifdef RAMRSBD_YES_THREADS
+    pthread_mutex_lock(&bd->lock);
+#else
+    (void)bd;
+#endif
+}
+
+static void ramrsbd_unlock(ramrsbd_t *bd) {
+#ifdef RAMRSBD_YES_THREADS
+    pthread_mutex_unlock(&bd->lock);
+#else
+    (void)bd;
+#endif
+}
+
+// drop any read-ahead, including any read-ahead still decoding, must be
+// called with the lock held
+static void ramrsbd_ra_invalidate(ramrsbd_t *bd) {
+    bd->ra_size = 0;
+    bd->ra_gen += 1;
+}
+
+// do two requests need to happen in order?
+static bool ramrsbd_conflicts(
+        const struct ramrsbd_req *a,
+        const struct ramrsbd_req *b) {
+    // sync waits for everything
+    if (a->op == RAMRSBD_OP_SYNC || b->op == RAMRSBD_OP_SYNC) {
+        return true;
+    }
+
+    // reads never conflict with each other
+    if (a->op == RAMRSBD_OP_READ && b->op == RAMRSBD_OP_READ) {
+        return false;
+    }
+
+    // but progs/erases conflict with anything in the same block
+    return a->block == b->block;
+}
+
+// find the next request we can start without overtaking any
+// conflicting requests, must be called with the lock held
+static struct ramrsbd_req *ramrsbd_next(ramrsbd_t *bd) {
+    for (lfs_size_t i = 0; i < bd->queue_count; i++) {
+        struct ramrsbd_req *req = bd->queue[i];
+        if (req->started) {
+            continue;
+        }
+
+        bool blocked = false;
+        for (lfs_size_t j = 0; j < i; j++) {
+            if (ramrsbd_conflicts(bd->queue[j], req)) {
+                blocked = true;
+                break;
+            }
+        }
+
+        if (!blocked) {
+            req->started = true;
+
+            // progs/erases invalidate our read-ahead
+            if ((req->op == RAMRSBD_OP_PROG || req->op == RAMRSBD_OP_ERASE)
+                    && req->block == bd->ra_block) {
+                ramrsbd_ra_invalidate(bd);
+            }
+
+            return req;
+        }
+    }
+
+    return NULL;
+}
+
+// decode ahead of sequential reads, must be called with the lock held
+static void ramrsbd_readahead(ramrsbd_t *bd, const struct ramrsbd_req *req) {
+    // only read ahead of sequential reads
+    bool sequential = (req->block == bd->ra_last_block
+            && req->off == bd->ra_last_off);
+    bd->ra_last_block = req->block;
+    bd->ra_last_off = req->off + req->size;
+    if (!sequential) {
+        return;
+    }
+
+    // already reading ahead? or no room in our queue?
+    if (!bd->ra_req.done || bd->queue_count == ramrsbd_queue_size(bd)) {
+        return;
+    }
+
+    // still at least half our read-ahead left?
+    lfs_off_t off = req->off + req->size;
+    if (bd->ra_size > 0
+            && bd->ra_block == req->block
+            && off >= bd->ra_off
+            && bd->ra_off+bd->ra_size >= off
+            && bd->ra_off+bd->ra_size - off
+                > bd->cfg->readahead_size/2) {
+        return;
+    }
+
+    // don't read past the end of the block
+    lfs_size_t size = lfs_min(bd->cfg->readahead_size,
+            (bd->cfg->erase_size/bd->cfg->code_size)
+                    * (bd->cfg->code_size-bd->cfg->ecc_size)
+                - off);
+    if (size == 0) {
+        return;
+    }
+
+    // queue read-ahead
+    bd->ra_req.op = RAMRSBD_OP_READ;
+    bd->ra_req.block = req->block;
+    bd->ra_req.off = off;
+    bd->ra_req.buffer = bd->ra_buffer[1];
+    bd->ra_req.size = size;
+    bd->ra_req.err = 0;
+    bd->ra_req.started = false;
+    bd->ra_req.done = false;
+    bd->ra_req_gen = bd->ra_gen;
+    bd->queue[bd->queue_count] = &bd->ra_req;
+    bd->queue_count += 1;
+}
+
+// process a request
+static int ramrsbd_process(ramrsbd_t *bd, struct ramrsbd_scratch *scratch,
+        struct ramrsbd_req *req) {
+    switch (req->op) {
+        case RAMRSBD_OP_READ: {
+            // can we read from our read-ahead? note read-ahead itself
+            // may overlap the previous read-ahead
+            ramrsbd_lock(bd);
+            lfs_size_t hit = 0;
+            if (bd->ra_size > 0
+                    && req->block == bd->ra_block
+                    && req->off >= bd->ra_off
+                    && req->off < bd->ra_off+bd->ra_size) {
+                hit = lfs_min(bd->ra_off+bd->ra_size - req->off, req->size);
+                // only use partial hits for read-ahead, otherwise we'd
+                // need to hold the lock while decoding
+                if (hit == req->size || req == &bd->ra_req) {
+                    memcpy(req->buffer,
+                            &bd->ra_buffer[0][req->off - bd->ra_off],
+                            hit);
+                } else {
+                    hit = 0;
+                }
+            }
+            ramrsbd_unlock(bd);
+
+            if (hit == req->size) {
+                return 0;
+            }
+
+            return ramrsbd_read_(bd, scratch,
+                    req->block, req->off + hit,
+                    (uint8_t*)req->buffer + hit, req->size - hit);
+        }
+
+        case RAMRSBD_OP_PROG:
+            return ramrsbd_prog_(bd, scratch,
+                    req->block, req->off, req->buffer, req->size);
+
+        case RAMRSBD_OP_ERASE:
+            return ramrsbd_erase_(bd, req->block);
+
+        case RAMRSBD_OP_SYNC:
+            return ramrsbd_sync_(bd, scratch);
+
+        case RAMRSBD_OP_FLUSH:
+            ramrsbd_flush_block(bd, scratch, req->block);
+            return 0;
+
+        default:
+            LFS_ASSERT(false);
+            return LFS_ERR_INVAL;
+    }
+}
+
+// run a request to completion
+static void ramrsbd_run(ramrsbd_t *bd, struct ramrsbd_scratch *scratch,
+        struct ramrsbd_req *req) {
+    req->err = ramrsbd_process(bd, scratch, req);
+
+    ramrsbd_lock(bd);
+    // remove from our queue
+    for (lfs_size_t i = 0; i < bd->queue_count; i++) {
+        if (bd->queue[i] == req) {
+            memmove(&bd->queue[i], &bd->queue[i+1],
+                    (bd->queue_count-(i+1)) * sizeof(struct ramrsbd_req*));
+            bd->queue_count -= 1;
+            break;
+        }
+    }
+
+    if (req == &bd->ra_req) {
+        // finished a read-ahead? swap it in, unless it went stale while
+        // decoding
+        if (!req->err && bd->ra_req_gen == bd->ra_gen) {
+            uint8_t *ra_buffer = bd->ra_buffer[0];
+            bd->ra_buffer[0] = bd->ra_buffer[1];
+            bd->ra_buffer[1] = ra_buffer;
+            bd->ra_block = req->block;
+            bd->ra_off = req->off;
+            bd->ra_size = req->size;
+        }
+        req->done = true;
+    } else if (req == &bd->flush_req) {
+        // finished background parity computation
+        req->done = true;
+    } else if (req->op == RAMRSBD_OP_READ && bd->cfg->readahead_size) {
+        ramrsbd_readahead(bd, req);
+    }
+
+#ifdef RAMRSBD_YES_THREADS
+    // there may be more work now that we're out of the way
+    pthread_cond_broadcast(&bd->work_cond);
+    pthread_cond_broadcast(&bd->done_cond);
+#endif
+    ramrsbd_unlock(bd);
+
+    if (req == &bd->ra_req || req == &bd->flush_req) {
+        return;
+    }
+
+    // call any completion callback before marking the request as done,
+    // the request may be deallocated after that
+    if (req->cb) {
+        req->cb(req);
+    }
+
+    ramrsbd_lock(bd);
+    req->done = true;
+#ifdef RAMRSBD_YES_THREADS
+    pthread_cond_broadcast(&bd->done_cond);
+#endif
+    ramrsbd_unlock(bd);
+}
+
+// process the next request in the calling thread, must be called with
+// the lock held
+//
+// returns false if there is nothing to do
+static bool ramrsbd_step(ramrsbd_t *bd) {
+    struct ramrsbd_req *req = ramrsbd_next(bd);
+    if (!req) {
+        return false;
+    }
+
+    ramrsbd_unlock(bd);
+    struct ramrsbd_scratch scratch = ramrsbd_scratch(bd);
+    ramrsbd_run(bd, &scratch, req);
+    ramrsbd_lock(bd);
+    return true;
+}
+
+// make progress on our queue, either by waiting for our workers or by
+// processing requests ourselves, must be called with the lock held
+static void ramrsbd_progress(ramrsbd_t *bd) {
+#ifdef RAMRSBD_YES_THREADS
+    if (bd->cfg->worker_count > 0) {
+        pthread_cond_wait(&bd->done_cond, &bd->lock);
+        return;
+    }
+#endif
+
+    // without workers, nothing else is in-flight, so there is always
+    // something to do
+    bool stepped = ramrsbd_step(bd);
+    LFS_ASSERT(stepped);
+    (void)stepped;
+}
+
+#ifdef RAMRSBD_YES_THREADS
+// compute deferred parity in the background, must be called with the
+// lock held
+//
+// returns false if there is nothing to do
+static bool ramrsbd_background(ramrsbd_t *bd) {
+    // already computing parity? or no room in our queue?
+    if (!bd->cfg->write_back
+            || bd->stopping
+            || !bd->flush_req.done
+            || bd->queue_count == ramrsbd_queue_size(bd)) {
+        return false;
+    }
+
+    // pick up where we left off
+    lfs_block_t block = ramrsbd_dirty_next(bd, bd->flush_block);
+    if (block == (lfs_block_t)-1) {
+        return false;
+    }
+    bd->flush_block = block;
+
+    // queue a flush, this makes sure we don't race any progs/erases to
+    // the same block
+    bd->flush_req.op = RAMRSBD_OP_FLUSH;
+    bd->flush_req.block = block;
+    bd->flush_req.off = 0;
+    bd->flush_req.buffer = NULL;
+    bd->flush_req.size = 0;
+    bd->flush_req.err = 0;
+    bd->flush_req.started = false;
+    bd->flush_req.done = false;
+    bd->queue[bd->queue_count] = &bd->flush_req;
+    bd->queue_count += 1;
+    return true;
+}
+
+// worker thread main loop
+static void *ramrsbd_work(void *p) {
+    struct ramrsbd_worker *worker = p;
+    ramrsbd_t *bd = worker->bd;
+
+    ramrsbd_lock(bd);
+    while (true) {
+        struct ramrsbd_req *req = ramrsbd_next(bd);
+        if (!req) {
+            // nothing left to do?
+            if (bd->stopping && bd->queue_count == 0) {
+                break;
+            }
+
+            // if we're idle, compute any deferred parity
+            if (ramrsbd_background(bd)) {
+                continue;
+            }
+
+            pthread_cond_wait(&bd->work_cond, &bd->lock);
+            continue;
+        }
+
+        ramrsbd_unlock(bd);
+        ramrsbd_run(bd, &worker->scratch, req);
+        ramrsbd_lock(bd);
+    }
+    ramrsbd_unlock(bd);
+
+    return NULL;
+}
+#endif
+
+// record a request in our binary trace, see RAMRSBD_RECORD_MAGIC
+static int ramrsbd_record(ramrsbd_t *bd, const struct ramrsbd_req *req) {
+    uint8_t record[1+3*4];
+    lfs_size_t size = 1;
+    record[0] = req->op;
+    if (req->op == RAMRSBD_OP_READ || req->op == RAMRSBD_OP_PROG) {
+        ramrsbd_record_le32(&record[1], req->block);
+        ramrsbd_record_le32(&record[5], req->off);
+        ramrsbd_record_le32(&record[9], req->size);
+        size = 1+3*4;
+    } else if (req->op == RAMRSBD_OP_ERASE) {
+        ramrsbd_record_le32(&record[1], req->block);
+        size = 1+4;
+    }
+
+    if (fwrite(record, 1, size, bd->record) != size) {
+        return LFS_ERR_IO;
+    }
+
+    // flush on sync, so traces survive crashes up to the last sync
+    if (req->op == RAMRSBD_OP_SYNC) {
+        if (fflush(bd->record) != 0) {
+            return LFS_ERR_IO;
+        }
+    }
+
+    return 0;
+}
+
+int ramrsbd_submit(const struct lfs_config *cfg, struct ramrsbd_req *req) {
+    RAMRSBD_TRACE("ramrsbd_submit(%p, %p {.op=%d, "
+                ".block=0x%"PRIx32", .off=%"PRIu32", "
+                ".buffer=%p, .size=%"PRIu32"})",
+            (void*)cfg, (void*)req, req->op,
+            req->block, req->off,
+            req->buffer, req->size);
+    ramrsbd_t *bd = cfg->context;
+
+    // check if request is valid
+    if (req->op == RAMRSBD_OP_READ) {
+        LFS_ASSERT(req->block < cfg->block_count);
+        LFS_ASSERT(req->off  % cfg->read_size == 0);
+        LFS_ASSERT(req->size % cfg->read_size == 0);
+        LFS_ASSERT(req->off+req->size <= cfg->block_size);
+    } else if (req->op == RAMRSBD_OP_PROG) {
+        LFS_ASSERT(req->block < cfg->block_count);
+        LFS_ASSERT(req->off  % cfg->prog_size == 0);
+        LFS_ASSERT(req->size % cfg->prog_size == 0);
+        LFS_ASSERT(req->off+req->size <= cfg->block_size);
+    } else if (req->op == RAMRSBD_OP_ERASE) {
+        LFS_ASSERT(req->block < cfg->block_count);
+    } else {
+        LFS_ASSERT(req->op == RAMRSBD_OP_SYNC);
+    }
+
+    req->err = 0;
+    req->started = false;
+    req->done = false;
+
+    ramrsbd_lock(bd);
+    // wait for room in our queue
+    while (bd->queue_count == ramrsbd_queue_size(bd)) {
+        ramrsbd_progress(bd);
+    }
+
+    // recording? note we record in submission order
+    if (bd->record) {
+        int err = ramrsbd_record(bd, req);
+        if (err) {
+            ramrsbd_unlock(bd);
+            RAMRSBD_TRACE("ramrsbd_submit -> %d", err);
+            return err;
+        }
+    }
+
+    bd->queue[bd->queue_count] = req;
+    bd->queue_count += 1;
+
+    // advance our fault clock?
+    if (bd->cfg->faults && bd->cfg->faults->tick_interval) {
+        bd->fault_ops += 1;
+        if (bd->fault_ops >= bd->cfg->faults->tick_interval) {
+            bd->fault_ops = 0;
+            bd->fault_clock += 1;
+            // any read-ahead is stale now
+            ramrsbd_ra_invalidate(bd);
+        }
+    }
+#ifdef RAMRSBD_YES_THREADS
+    pthread_cond_signal(&bd->work_cond);
+#endif
+    ramrsbd_unlock(bd);
+
+    RAMRSBD_TRACE("ramrsbd_submit -> %d", 0);
     return 0;
 }
 
+int ramrsbd_poll(const struct lfs_config *cfg, struct ramrsbd_req *req) {
+    RAMRSBD_TRACE("ramrsbd_poll(%p, %p)", (void*)cfg, (void*)req);
+    ramrsbd_t *bd = cfg->context;
+
+    ramrsbd_lock(bd);
+    // without workers, it's up to us to make progress
+    if (bd->cfg->worker_count == 0) {
+        while (!req->done && ramrsbd_step(bd)) {
+        }
+    }
+
+    int err = (req->done) ? req->err : 1;
+    ramrsbd_unlock(bd);
+
+    RAMRSBD_TRACE("ramrsbd_poll -> %d", err);
+    return err;
+}
+
+int ramrsbd_wait(const struct lfs_config *cfg, struct ramrsbd_req *req) {
+    RAMRSBD_TRACE("ramrsbd_wait(%p, %p)", (void*)cfg, (void*)req);
+    ramrsbd_t *bd = cfg->context;
+
+    ramrsbd_lock(bd);
+    while (!req->done) {
+        ramrsbd_progress(bd);
+    }
+
+    int err = req->err;
+    ramrsbd_unlock(bd);
+
+    RAMRSBD_TRACE("ramrsbd_wait -> %d", err);
+    return err;
+}
+
+
+// synchronous wrappers
+
+int ramrsbd_read(const struct lfs_config *cfg, lfs_block_t block,
+        lfs_off_t off, void *buffer, lfs_size_t size) {
+    RAMRSBD_TRACE("ramrsbd_read(%p, "
+                "0x%"PRIx32", %"PRIu32", %p, %"PRIu32")",
+            (void*)cfg, block, off, buffer, size);
+
+    struct ramrsbd_req req = {
+        .op = RAMRSBD_OP_READ,
+        .block = block,
+        .off = off,
+        .buffer = buffer,
+        .size = size,
+    };
+    int err = ramrsbd_submit(cfg, &req);
+    if (!err) {
+        err = ramrsbd_wait(cfg, &req);
+    }
+
+    RAMRSBD_TRACE("ramrsbd_read -> %d", err);
+    return err;
+}
+
+int ramrsbd_prog(const struct lfs_config *cfg, lfs_block_t block,
+        lfs_off_t off, const void *buffer, lfs_size_t size) {
+    RAMRSBD_TRACE("ramrsbd_prog(%p, "
+                "0x%"PRIx32", %"PRIu32", %p, %"PRIu32")",
+            (void*)cfg, block, off, buffer, size);
+
+    struct ramrsbd_req req = {
+        .op = RAMRSBD_OP_PROG,
+        .block = block,
+        .off = off,
+        .buffer = (void*)buffer,
+        .size = size,
+    };
+    int err = ramrsbd_submit(cfg, &req);
+    if (!err) {
+        err = ramrsbd_wait(cfg, &req);
+    }
+
+    RAMRSBD_TRACE("ramrsbd_prog -> %d", err);
+    return err;
+}
+
+int ramrsbd_erase(const struct lfs_config *cfg, lfs_block_t block) {
+    RAMRSBD_TRACE("ramrsbd_erase(%p, 0x%"PRIx32" (%"PRIu32"))",
+            (void*)cfg, block, ((ramrsbd_t*)cfg->context)->cfg->erase_size);
+
+    struct ramrsbd_req req = {
+        .op = RAMRSBD_OP_ERASE,
+        .block = block,
+    };
+    int err = ramrsbd_submit(cfg, &req);
+    if (!err) {
+        err = ramrsbd_wait(cfg, &req);
+    }
+
+    RAMRSBD_TRACE("ramrsbd_erase -> %d", err);
+    return err;
+}
+
 int ramrsbd_sync(const struct lfs_config *cfg) {
     RAMRSBD_TRACE("ramrsbd_sync(%p)", (void*)cfg);
 
-    // sync is a noop
-    (void)cfg;
+    struct ramrsbd_req req = {
+        .op = RAMRSBD_OP_SYNC,
+    };
+    int err = ramrsbd_submit(cfg, &req);
+    if (!err) {
+        err = ramrsbd_wait(cfg, &req);
+    }
+
+    RAMRSBD_TRACE("ramrsbd_sync -> %d", err);
+    return err;
+}
+
+
+// fault injection control
+
+int ramrsbd_tick(const struct lfs_config *cfg, uint32_t ticks) {
+    RAMRSBD_TRACE("ramrsbd_tick(%p, %"PRIu32")", (void*)cfg, ticks);
+    ramrsbd_t *bd = cfg->context;
+    LFS_ASSERT(bd->cfg->faults);
+
+    ramrsbd_lock(bd);
+    bd->fault_clock += ticks;
+    // any read-ahead is stale now
+    ramrsbd_ra_invalidate(bd);
+    ramrsbd_unlock(bd);
+
+    RAMRSBD_TRACE("ramrsbd_tick -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_inject(const struct lfs_config *cfg, lfs_block_t block) {
+    RAMRSBD_TRACE("ramrsbd_inject(%p, 0x%"PRIx32")", (void*)cfg, block);
+    ramrsbd_t *bd = cfg->context;
+    LFS_ASSERT(bd->cfg->faults);
+    LFS_ASSERT(block < cfg->block_count);
+
+    ramrsbd_lock(bd);
+    // we're about to modify the buffer, so wait for any in-flight
+    // requests, this also means our scratch space is free
+    while (bd->queue_count > 0) {
+        ramrsbd_progress(bd);
+    }
+
+    // unallocated sparse blocks don't have any faults
+    if (bd->blocks && !bd->blocks[block]) {
+        ramrsbd_unlock(bd);
+        RAMRSBD_TRACE("ramrsbd_inject -> %d", 0);
+        return 0;
+    }
+
+    // make sure we're not writing to a shared block
+    int err = ramrsbd_cow(bd, block);
+    if (err) {
+        ramrsbd_unlock(bd);
+        RAMRSBD_TRACE("ramrsbd_inject -> %d", err);
+        return err;
+    }
+
+    // compute any deferred parity, otherwise we'd end up protecting our
+    // faults
+    if (bd->cfg->write_back) {
+        struct ramrsbd_scratch scratch = ramrsbd_scratch(bd);
+        ramrsbd_flush_(bd, &scratch, block, 0,
+                (bd->cfg->erase_size/bd->cfg->code_size)
+                    * (bd->cfg->code_size-bd->cfg->ecc_size));
+    }
+
+    // write faults into each codeword
+    for (lfs_off_t off = 0;
+            off < (bd->cfg->erase_size/bd->cfg->code_size)
+                * (bd->cfg->code_size-bd->cfg->ecc_size);
+            off += bd->cfg->code_size-bd->cfg->ecc_size) {
+        uint8_t *m = ramrsbd_find_m(bd, block, off);
+        uint8_t *e = ramrsbd_find_e(bd, block, off);
+        memcpy(bd->c, m, bd->cfg->code_size-bd->cfg->ecc_size);
+        memcpy(&bd->c[bd->cfg->code_size-bd->cfg->ecc_size],
+                e, bd->cfg->ecc_size);
+
+        ramrsbd_fault(bd, bd->fault_clock, block,
+                (off / (bd->cfg->code_size-bd->cfg->ecc_size))
+                    * bd->cfg->code_size,
+                bd->c);
+
+        memcpy(m, bd->c, bd->cfg->code_size-bd->cfg->ecc_size);
+        memcpy(e, &bd->c[bd->cfg->code_size-bd->cfg->ecc_size],
+                bd->cfg->ecc_size);
+    }
+
+    // restart the block's fault clock so we don't apply faults twice
+    bd->fault_time[block] = bd->fault_clock;
+    // and any read-ahead is stale, including any in-flight read-ahead
+    ramrsbd_ra_invalidate(bd);
+    ramrsbd_unlock(bd);
+
+    RAMRSBD_TRACE("ramrsbd_inject -> %d", 0);
+    return 0;
+}
+
+
+// copy-on-write snapshots
+
+int ramrsbd_snapshot(const struct lfs_config *cfg,
+        ramrsbd_snapshot_t *snapshot) {
+    RAMRSBD_TRACE("ramrsbd_snapshot(%p, %p)", (void*)cfg, (void*)snapshot);
+    ramrsbd_t *bd = cfg->context;
+    LFS_ASSERT(bd->blocks);
+
+    // allocate blocks, and any fault/level state, in one go
+    lfs_size_t fault_size = (bd->cfg->faults)
+            ? 2*bd->cfg->erase_count * sizeof(uint32_t)
+            : 0;
+    lfs_size_t level_size = (bd->cfg->ecc_level_count > 0)
+            ? 2*bd->cfg->erase_count
+            : 0;
+    uint8_t *buffer = lfs_malloc(
+            bd->cfg->erase_count * sizeof(struct ramrsbd_block*)
+                + fault_size
+                + level_size);
+    if (!buffer) {
+        RAMRSBD_TRACE("ramrsbd_snapshot -> %d", LFS_ERR_NOMEM);
+        return LFS_ERR_NOMEM;
+    }
+    snapshot->cfg = bd->cfg;
+    snapshot->blocks = (struct ramrsbd_block**)buffer;
+    buffer += bd->cfg->erase_count * sizeof(struct ramrsbd_block*);
+    snapshot->fault_wear = (fault_size) ? (uint32_t*)buffer : NULL;
+    buffer += fault_size;
+    snapshot->levels = (level_size) ? buffer : NULL;
+
+    ramrsbd_lock(bd);
+    // wait for any in-flight requests so we see a consistent device
+    while (bd->queue_count > 0) {
+        ramrsbd_progress(bd);
+    }
+
+    // compute any deferred parity, snapshots don't track dirty parity
+    if (bd->cfg->write_back) {
+        struct ramrsbd_scratch scratch = ramrsbd_scratch(bd);
+        ramrsbd_flush_all(bd, &scratch);
+    }
+
+    // share our blocks
+    ramrsbd_block_lock();
+    for (lfs_block_t i = 0; i < bd->cfg->erase_count; i++) {
+        snapshot->blocks[i] = bd->blocks[i];
+        if (snapshot->blocks[i]) {
+            snapshot->blocks[i]->refs += 1;
+        }
+    }
+    ramrsbd_block_unlock();
+
+    // and copy any other state
+    if (fault_size) {
+        memcpy(snapshot->fault_wear, bd->fault_wear, fault_size);
+    }
+    if (level_size) {
+        memcpy(snapshot->levels, bd->levels, level_size);
+    }
+    snapshot->fault_clock = bd->fault_clock;
+    ramrsbd_unlock(bd);
+
+    RAMRSBD_TRACE("ramrsbd_snapshot -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_snapshot_destroy(ramrsbd_snapshot_t *snapshot) {
+    RAMRSBD_TRACE("ramrsbd_snapshot_destroy(%p)", (void*)snapshot);
+
+    for (lfs_block_t i = 0; i < snapshot->cfg->erase_count; i++) {
+        if (snapshot->blocks[i]) {
+            ramrsbd_block_decref(snapshot->blocks[i]);
+        }
+    }
+    // everything else lives in the same allocation
+    lfs_free(snapshot->blocks);
+
+    RAMRSBD_TRACE("ramrsbd_snapshot_destroy -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_fork(const struct lfs_config *cfg,
+        const ramrsbd_snapshot_t *snapshot) {
+    RAMRSBD_TRACE("ramrsbd_fork(%p, %p)", (void*)cfg, (void*)snapshot);
+    ramrsbd_t *bd = cfg->context;
+    LFS_ASSERT(bd->blocks);
+
+    // the snapshot must be compatible with our configuration
+    LFS_ASSERT(snapshot->cfg->code_size == bd->cfg->code_size);
+    LFS_ASSERT(snapshot->cfg->ecc_size == bd->cfg->ecc_size);
+    LFS_ASSERT(snapshot->cfg->erase_size == bd->cfg->erase_size);
+    LFS_ASSERT(snapshot->cfg->erase_count == bd->cfg->erase_count);
+    LFS_ASSERT(snapshot->cfg->layout == bd->cfg->layout);
+    LFS_ASSERT(snapshot->cfg->ecc_level_count == bd->cfg->ecc_level_count);
+    LFS_ASSERT(!snapshot->cfg->faults == !bd->cfg->faults);
+
+    ramrsbd_lock(bd);
+    // we're about to replace our blocks, so wait for any in-flight
+    // requests
+    while (bd->queue_count > 0) {
+        ramrsbd_progress(bd);
+    }
+
+    // share the snapshot's blocks, releasing our own
+    for (lfs_block_t i = 0; i < bd->cfg->erase_count; i++) {
+        struct ramrsbd_block *b = bd->blocks[i];
+        if (snapshot->blocks[i]) {
+            ramrsbd_block_lock();
+            snapshot->blocks[i]->refs += 1;
+            ramrsbd_block_unlock();
+        }
+        bd->blocks[i] = snapshot->blocks[i];
+        if (b) {
+            ramrsbd_block_release(bd, b);
+        }
+    }
+
+    // and copy any other state
+    if (bd->cfg->faults) {
+        memcpy(bd->fault_wear, snapshot->fault_wear,
+                2*bd->cfg->erase_count * sizeof(uint32_t));
+    }
+    if (bd->cfg->ecc_level_count > 0) {
+        memcpy(bd->levels, snapshot->levels, 2*bd->cfg->erase_count);
+    }
+    bd->fault_clock = snapshot->fault_clock;
+    bd->fault_ops = 0;
+
+    // snapshots never have dirty parity
+    if (bd->cfg->write_back) {
+        memset(bd->dirty, 0,
+                (bd->cfg->erase_count
+                        * (bd->cfg->erase_size/bd->cfg->code_size)
+                    + 7) / 8);
+        bd->dirty_count = 0;
+    }
+
+    // any read-ahead is stale now
+    ramrsbd_ra_invalidate(bd);
+    bd->ra_last_block = -1;
+    ramrsbd_unlock(bd);
 
-    RAMRSBD_TRACE("ramrsbd_sync -> %d", 0);
+    RAMRSBD_TRACE("ramrsbd_fork -> %d", 0);
     return 0;
 }
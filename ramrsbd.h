@@ -9,6 +9,13 @@
 
 #include "lfs.h"
 #include "lfs_util.h"
+#include "ramrsbd_rs.h"
+
+#include <stdio.h>
+
+#ifdef RAMRSBD_YES_THREADS
+#include <pthread.h>
+#endif
 
 #ifdef __cplusplus
 extern "C"
@@ -25,6 +32,66 @@ extern "C"
 #endif
 #endif
 
+// Codeword layouts
+enum ramrsbd_layout {
+    // Store each codeword's ecc right after its message
+    RAMRSBD_LAYOUT_INTERLEAVED  = 0,
+    // Store all messages in an erase block contiguously, with ecc in a
+    // separate out-of-band region at the end of the erase block
+    RAMRSBD_LAYOUT_OOB          = 1,
+};
+
+// Error-correcting codes
+enum ramrsbd_codec {
+    // Reed-Solomon, corrects byte errors
+    RAMRSBD_CODEC_RS    = 0,
+    // Binary BCH, corrects bit errors
+    RAMRSBD_CODEC_BCH   = 1,
+};
+
+// Fault injection config, see ramrsbd_config.faults
+//
+// Faults are a deterministic function of the seed, their location, and
+// how many fault clock ticks have passed since their erase block was
+// last erased, so they accumulate over time without touching the buffer,
+// and are applied lazily as codewords are read. ramrsbd_inject can write
+// them into the buffer if needed.
+//
+// Rates are probabilities out of 2^32.
+struct ramrsbd_faults {
+    // Seed for deterministic fault injection.
+    uint32_t seed;
+
+    // Probability of each bit flipping per tick.
+    uint32_t bit_error_rate;
+
+    // Additional probability of each bit flipping per tick, for every
+    // time its erase block has been erased.
+    uint32_t wear_rate;
+
+    // Probability of a burst error in each codeword per tick.
+    uint32_t burst_rate;
+
+    // Number of consecutive bits flipped by a burst error.
+    lfs_size_t burst_size;
+
+    // Probability of each byte being stuck at 0x00 or 0xff.
+    //
+    // Stuck bytes are permanent defects, and don't depend on ticks.
+    uint32_t stuck_rate;
+
+    // Advance the fault clock every n requests.
+    //
+    // By default, when zero, the fault clock only advances with
+    // ramrsbd_tick.
+    lfs_size_t tick_interval;
+
+    // Optional statically allocated wear/age buffer.
+    //
+    // Must be 2*erase_count*sizeof(uint32_t).
+    void *buffer;
+};
+
 // rambd config
 struct ramrsbd_config {
     // Size of a codeword in bytes.
@@ -49,7 +116,8 @@ struct ramrsbd_config {
     // Number of erase blocks on the device.
     lfs_size_t erase_count;
 
-    // Number of byte errors to try to correct.
+    // Number of byte errors, or bit errors with RAMRSBD_CODEC_BCH, to try
+    // to correct.
     //
     // There is a tradeoff here. Every byte error you try to correct is two
     // fewer byte errors you can detect reliably. That being said, recovering
@@ -59,17 +127,182 @@ struct ramrsbd_config {
     // -1 disables error correction and errors on any errors.
     lfs_ssize_t error_correction;
 
+    // Optional weaker ecc levels, to adapt ecc to each erase block.
+    //
+    // Erase blocks start at the first level, and move up a level when
+    // erased if reads needed at least half of the level's correction
+    // capability. ecc_size is always the last level.
+    //
+    // Codewords still reserve ecc_size bytes of ecc, so this saves
+    // encode/decode work on healthy blocks, but not space.
+    //
+    // Must be increasing and less than ecc_size.
+    const lfs_size_t *ecc_levels;
+
+    // Number of ecc_levels.
+    lfs_size_t ecc_level_count;
+
+    // Error-correcting code to use.
+    //
+    // By default, RAMRSBD_CODEC_RS, a Reed-Solomon code that can correct
+    // up to floor(ecc_size/2) byte errors. RAMRSBD_CODEC_BCH uses a
+    // binary BCH code that can correct up to ecc_size bit errors
+    // instead, which is more useful if errors are mostly scattered
+    // single-bit flips.
+    //
+    // Binary BCH is limited to at most 31 byte codewords, and can't be
+    // used with ecc_levels.
+    enum ramrsbd_codec codec;
+
+    // Layout of codewords in each erase block.
+    //
+    // By default, RAMRSBD_LAYOUT_INTERLEAVED, each codeword's ecc follows
+    // its message. RAMRSBD_LAYOUT_OOB keeps the messages contiguous, which
+    // is useful if something else wants to access the raw buffer.
+    enum ramrsbd_layout layout;
+
     // Optional precomputed generator polynomial.
     //
-    // See the rs-poly.py script to help generate this.
+    // See the rs-poly.py script to help generate this. With
+    // RAMRSBD_CODEC_BCH this is a binary polynomial, one bit per term.
     //
     // By default p is computed as needed for the configured ecc_size.
     // Must be ecc_size.
     const uint8_t *p;
 
+    // Optional precomputed decode plan, see ramrsbd_rs_plan.
+    //
+    // A plan only depends on the number of positions in a codeword, and
+    // is indexed from the end of the codeword, so one plan can be shared
+    // by every device with the same codec and a code_size, at any
+    // ecc_size or ecc level, that fits in the plan. By default a plan is
+    // built when the block device is created.
+    //
+    // Must have at least code_size positions, or 8*code_size with
+    // RAMRSBD_CODEC_BCH.
+    const ramrsbd_rs_plan_t *plan;
+
     // Optional statically allocated buffer for the block device.
     void *buffer;
 
+    // Optional path to a file backing the block device.
+    //
+    // The file is mapped into memory, so its contents persist across
+    // ramrsbd_create/ramrsbd_destroy and ramrsbd_sync flushes it to disk.
+    // An existing image of the right size is mapped as is, without
+    // zeroing, so startup is O(1) regardless of device size. A new or
+    // empty image is grown to fit, but an image of any other size is
+    // left untouched and ramrsbd_create returns LFS_ERR_INVAL.
+    //
+    // Requires RAMRSBD_YES_MMAP. Without a path, RAMRSBD_YES_MMAP still
+    // maps anonymous memory, which the OS zeros lazily.
+    const char *path;
+
+    // Advise the OS to back the block device with huge pages.
+    //
+    // This is only a hint, and requires RAMRSBD_YES_MMAP.
+    bool huge_pages;
+
+    // Store erase blocks as refcounted copy-on-write blocks.
+    //
+    // This allows cheap snapshots with ramrsbd_snapshot, and forking
+    // devices from snapshots with ramrsbd_fork. Blocks are shared until
+    // written, so neither copies any data.
+    //
+    // Erase blocks are allocated separately, so this can't be used with
+    // a buffer or path.
+    bool copy_on_write;
+
+    // Allocate erase blocks lazily.
+    //
+    // Erase blocks are allocated on first prog, and returned to an
+    // internal pool when erased. Unallocated blocks read as zeros
+    // without any decoding, or faults, so large mostly-empty devices
+    // are cheap to create and read.
+    //
+    // Sparse blocks are also copy-on-write, so this implies
+    // copy_on_write, and can't be used with a buffer or path.
+    bool sparse;
+
+    // Number of requests that can be queued with ramrsbd_submit.
+    //
+    // Submitting to a full queue blocks until a request completes.
+    //
+    // Defaults to 1 when zero.
+    lfs_size_t queue_size;
+
+    // Number of worker threads encoding/decoding requests.
+    //
+    // By default, when zero, requests are processed in the calling
+    // thread by ramrsbd_poll/ramrsbd_wait, and ramrsbd is not
+    // thread-safe.
+    //
+    // Requires RAMRSBD_YES_THREADS.
+    lfs_size_t worker_count;
+
+    // Number of bytes to decode ahead of sequential reads.
+    //
+    // Decoded codewords are cached until the block is progged/erased, so
+    // modifying the buffer directly won't be noticed by cached reads.
+    //
+    // Must be a multiple of the read size. Zero disables read-ahead.
+    lfs_size_t readahead_size;
+
+    // Defer computing parity until it's needed.
+    //
+    // Progs only store the message, and mark its codewords as dirty.
+    // Parity is then computed in batches at sync, on the first read of a
+    // dirty codeword, or in the background by idle worker threads, so
+    // progs are little more than a memcpy.
+    //
+    // Dirty codewords aren't protected until their parity is computed,
+    // and with a path, the file may be inconsistent until ramrsbd_sync.
+    bool write_back;
+
+    // Minimum number of codewords to encode with the bitsliced encoder.
+    //
+    // Progs, and deferred parity, covering at least this many codewords
+    // are encoded RAMRSBD_RS_LANES at a time with
+    // ramrsbd_rs_encode_bitsliced, which is faster for many codewords,
+    // but needs RAMRSBD_RS_PLANES_SIZE(ecc_size) bytes of scratch per
+    // thread.
+    //
+    // By default, when zero, the bitsliced encoder isn't used. Not
+    // supported with RAMRSBD_CODEC_BCH.
+    lfs_size_t bitslice_threshold;
+
+    // Optional fault injection, see struct ramrsbd_faults.
+    //
+    // Useful for testing and benchmarking under realistic error loads.
+    const struct ramrsbd_faults *faults;
+
+    // Optional path to record a binary trace of requests to.
+    //
+    // Every read/prog/erase/sync is recorded as it is submitted, so the
+    // trace can be replayed against other configurations with
+    // ramrsbd_replay. See RAMRSBD_RECORD_MAGIC for the format.
+    const char *record_path;
+
+    // Optional statically allocated queue buffer.
+    //
+    // Must be queue_size*sizeof(struct ramrsbd_req*).
+    void *queue_buffer;
+
+    // Optional statically allocated read-ahead buffer.
+    //
+    // Must be 2*readahead_size.
+    void *readahead_buffer;
+
+    // Optional statically allocated ecc level buffer.
+    //
+    // Must be 2*erase_count + the sum of ecc_levels.
+    void *level_buffer;
+
+    // Optional statically allocated dirty parity buffer.
+    //
+    // Must be (erase_count*(erase_size/code_size)+7)/8.
+    void *dirty_buffer;
+
     // Optional statically allocated codeword buffer.
     //
     // Must be code_size.
@@ -82,26 +315,122 @@ struct ramrsbd_config {
     // Must be ecc_size.
     void *p_buffer;
 
+    // Optional statically allocated decode plan buffer.
+    //
+    // Not needed if a precomputed plan is provided.
+    //
+    // Must be RAMRSBD_RS_PLAN_SIZE(code_size), or
+    // RAMRSBD_RS_PLAN_SIZE(8*code_size) with RAMRSBD_CODEC_BCH.
+    void *plan_buffer;
+
     // Optional statically allocated syndrome buffer.
     //
-    // Must be ecc_size.
+    // Must be ecc_size, or 2*ecc_size with RAMRSBD_CODEC_BCH.
     void *s_buffer;
 
     // Optional statically allocated error-locator polynomial buffer.
     //
-    // Must be ecc_size.
+    // Must be ecc_size, or 2*ecc_size with RAMRSBD_CODEC_BCH.
     void *λ_buffer;
 
     // Optional statically allocated error-evaluator polynomial buffer.
     //
-    // Must be ecc_size.
+    // Must be ecc_size, or 2*ecc_size with RAMRSBD_CODEC_BCH.
     void *ω_buffer;
+
+    // Optional statically allocated bitsliced encoder buffer.
+    //
+    // Must be RAMRSBD_RS_PLANES_SIZE(ecc_size), and aligned to uint64_t.
+    void *bitslice_buffer;
+};
+
+// Asynchronous operations
+enum ramrsbd_op {
+    RAMRSBD_OP_READ     = 1,
+    RAMRSBD_OP_PROG     = 2,
+    RAMRSBD_OP_ERASE    = 3,
+    RAMRSBD_OP_SYNC     = 4,
+    // internal, computes deferred parity in the background, can't be
+    // submitted
+    RAMRSBD_OP_FLUSH    = 5,
+};
+
+// Binary trace format, see ramrsbd_config.record_path
+//
+// A trace starts with an 8-byte magic string, the last byte being the
+// format version, followed by the geometry of the recording device as
+// little-endian 32-bit words:
+//
+//   magic, read_size, prog_size, block_size, block_count
+//
+// Each request is then a 1-byte enum ramrsbd_op followed by its
+// arguments as little-endian 32-bit words:
+//
+//   read:  op, block, off, size
+//   prog:  op, block, off, size
+//   erase: op, block
+//   sync:  op
+//
+// Data isn't recorded, so traces stay small.
+#define RAMRSBD_RECORD_MAGIC "ramrsbd\x01"
+
+// An asynchronous request, see ramrsbd_submit
+//
+// The request, and its buffer, must stay allocated until the request
+// completes.
+struct ramrsbd_req {
+    // Operation to perform.
+    enum ramrsbd_op op;
+
+    // Block, offset, buffer, and size of the operation, with the same
+    // constraints as ramrsbd_read/ramrsbd_prog/ramrsbd_erase.
+    //
+    // Note prog only reads from the buffer.
+    lfs_block_t block;
+    lfs_off_t off;
+    void *buffer;
+    lfs_size_t size;
+
+    // Optional completion callback.
+    //
+    // This is called from whatever thread completes the request, before
+    // ramrsbd_poll/ramrsbd_wait see the request as complete. Be careful
+    // submitting from callbacks, a full queue may deadlock.
+    void (*cb)(struct ramrsbd_req *req);
+
+    // Optional user data for the callback.
+    void *data;
+
+    // Result of the request, valid after completion.
+    int err;
+
+    // internal state
+    bool started;
+    bool done;
 };
 
+struct ramrsbd_worker;
+struct ramrsbd_block;
+
 // rambd state
 typedef struct ramrsbd {
     uint8_t *buffer;
     const struct ramrsbd_config *cfg;
+    // file descriptor if mapped to a file, -1 otherwise
+    int fd;
+    // erase blocks if copy-on-write or sparse, NULL otherwise, sparse
+    // blocks are NULL until allocated
+    struct ramrsbd_block **blocks; // erase_count
+    // free blocks, if sparse
+    struct ramrsbd_block *pool;
+    // binary trace, if recording
+    FILE *record;
+    // where codewords live in an erase block, precomputed from our
+    // layout, the i-th message is at i*m_stride, and its ecc at
+    // e_off + i*e_stride
+    lfs_size_t m_stride;
+    lfs_size_t e_off;
+    lfs_size_t e_stride;
 
     // various buffers for internal math
 
@@ -110,13 +439,71 @@ typedef struct ramrsbd {
     // generator polynomial P(x), with implied leading 1
     uint8_t *p; // ecc_size
     // syndrome polynomial S(x)
-    uint8_t *s; // ecc_size
+    uint8_t *s; // ecc_size, 2*ecc_size if bch
     // error-locator polynomial Λ(x)
-    uint8_t *λ; // ecc_size
+    uint8_t *λ; // ecc_size, 2*ecc_size if bch
     // error-evaluator polynomial Ω(x)
-    uint8_t *ω; // ecc_size
+    uint8_t *ω; // ecc_size, 2*ecc_size if bch
+    // bit planes for the bitsliced encoder, if enabled
+    uint64_t *planes; // RAMRSBD_RS_PLANES_SIZE(ecc_size)
+    // decode plan, precomputed tables for our code_size
+    ramrsbd_rs_plan_t plan;
+
+    // ecc level of each erase block, and the most errors seen since the
+    // block was last erased
+    uint8_t *levels; // erase_count
+    uint8_t *level_errors; // erase_count
+    // generator polynomials of each ecc level, excluding ecc_size
+    uint8_t *level_p; // sum of ecc_levels
+
+    // queued and in-flight requests, in submission order
+    struct ramrsbd_req **queue; // queue_size
+    lfs_size_t queue_count;
+
+    // read-ahead state, decoded messages are double-buffered so reads
+    // can hit the cache while the next read-ahead is decoding
+    uint8_t *ra_buffer[2]; // readahead_size
+    struct ramrsbd_req ra_req;
+    lfs_block_t ra_block;
+    lfs_off_t ra_off;
+    lfs_size_t ra_size;
+    lfs_block_t ra_last_block;
+    lfs_off_t ra_last_off;
+    // bumped whenever read-ahead goes stale, an in-flight read-ahead
+    // issued at an older generation is dropped
+    uint32_t ra_gen;
+    uint32_t ra_req_gen;
+
+    // deferred parity state, one bit per codeword if write-back
+    uint8_t *dirty; // erase_count*(erase_size/code_size) bits
+    lfs_size_t dirty_count;
+    struct ramrsbd_req flush_req;
+    lfs_block_t flush_block;
+
+    // fault injection state
+    uint32_t *fault_wear; // erase_count
+    uint32_t *fault_time; // erase_count
+    uint32_t fault_clock;
+    lfs_size_t fault_ops;
+
+#ifdef RAMRSBD_YES_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    struct ramrsbd_worker *workers; // worker_count
+    bool stopping;
+#endif
 } ramrsbd_t;
 
+// A copy-on-write snapshot, see ramrsbd_snapshot
+typedef struct ramrsbd_snapshot {
+    const struct ramrsbd_config *cfg;
+    struct ramrsbd_block **blocks; // erase_count
+    uint32_t *fault_wear; // 2*erase_count, if faults
+    uint8_t *levels; // 2*erase_count, if ecc levels
+    uint32_t fault_clock;
+} ramrsbd_snapshot_t;
+
 
 // Create a RAM block device
 int ramrsbd_create(const struct lfs_config *cfg,
@@ -144,6 +531,66 @@ int ramrsbd_erase(const struct lfs_config *cfg, lfs_block_t block);
 // Sync the block device
 int ramrsbd_sync(const struct lfs_config *cfg);
 
+// Submit an asynchronous request
+//
+// Requests that don't touch the same block may complete out of order,
+// but a request never overtakes an earlier prog/erase to the same block,
+// and sync waits for all earlier requests.
+//
+// Blocks if the queue is full.
+int ramrsbd_submit(const struct lfs_config *cfg, struct ramrsbd_req *req);
+
+// Poll an asynchronous request
+//
+// Returns 1 if the request is still in progress, otherwise the result
+// of the request.
+//
+// Without worker threads, this processes queued requests until the
+// request completes.
+int ramrsbd_poll(const struct lfs_config *cfg, struct ramrsbd_req *req);
+
+// Wait for an asynchronous request to complete
+//
+// Returns the result of the request.
+int ramrsbd_wait(const struct lfs_config *cfg, struct ramrsbd_req *req);
+
+// Advance the fault clock
+//
+// Faults accumulate in each erase block with every tick since the block
+// was last erased.
+int ramrsbd_tick(const struct lfs_config *cfg, uint32_t ticks);
+
+// Write any faults in a block into the buffer
+//
+// This makes the faults permanent, until the block is progged again, and
+// restarts the block's fault clock so faults aren't applied twice.
+int ramrsbd_inject(const struct lfs_config *cfg, lfs_block_t block);
+
+// Take a snapshot of a block device
+//
+// Requires ramrsbd_config.copy_on_write or sparse. Erase blocks are
+// shared with the snapshot until written, so this doesn't copy any data.
+// The snapshot also captures any ecc levels and fault injection state.
+//
+// The snapshot references the device's ramrsbd_config, which must
+// outlive the snapshot.
+int ramrsbd_snapshot(const struct lfs_config *cfg,
+        ramrsbd_snapshot_t *snapshot);
+
+// Clean up memory associated with a snapshot
+//
+// Any devices forked from the snapshot are unaffected.
+int ramrsbd_snapshot_destroy(ramrsbd_snapshot_t *snapshot);
+
+// Fork a block device from a snapshot
+//
+// This replaces the contents of the block device with the snapshot,
+// sharing erase blocks until written. The block device must have the
+// same configuration as the device the snapshot was taken from, but
+// may be a different device.
+int ramrsbd_fork(const struct lfs_config *cfg,
+        const ramrsbd_snapshot_t *snapshot);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,289 @@
+/*
+ * Binary BCH encoding/decoding utilities
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "ramrsbd_bch.h"
+#include "ramrsbd_rs.h"
+
+
+// get a bit in a big-endian bit string, bit 0 is the msb of byte 0
+static inline uint8_t ramrsbd_bch_bit(const uint8_t *b, lfs_size_t i) {
+    return (b[i/8] >> (7-i%8)) & 1;
+}
+
+// flip a bit in a big-endian bit string
+static inline void ramrsbd_bch_flip(uint8_t *b, lfs_size_t i) {
+    b[i/8] ^= 0x80 >> (i%8);
+}
+
+
+// Find the generator polynomial P(x) for ecc_size bytes of ecc
+void ramrsbd_bch_p(uint8_t *p, lfs_size_t ecc_size) {
+    // calculate generator polynomial
+    //
+    // to correct t=n/8 bit errors, we need P(x) to evaluate to 0 at
+    // every x=g^i for 1 <= i <= 2t, but we also need P(x) to only have
+    // binary coefficients
+    //
+    // the trick is that if g^i is a root of a binary polynomial, so is
+    // g^2i, so P(x) is the product of each minimal polynomial:
+    //
+    // M_i(x) = prod_j (x - g^j) for j in {i, 2i, 4i, ...} mod 255
+    //
+    // there are at most 8 of these per i, and the even i's cosets are
+    // already covered by the odd i's cosets, so P(x) needs at most 8t
+    // bits
+    //
+    // if P(x) ends up smaller than 8t bits, we shift it up to fill all
+    // n bytes of ecc, this doesn't change any roots except 0
+    //
+
+    // let P(x) = x^8n, with an implied leading 1
+    memset(p, 0, ecc_size);
+    lfs_size_t p_size = 8*ecc_size;
+
+    for (lfs_size_t i = 1; i < 2*ecc_size; i += 2) {
+        // skip cosets we've already included, each coset is included
+        // by its smallest member
+        bool seen = false;
+        lfs_size_t k = 0;
+        uint32_t j = i;
+        do {
+            if (j < i) {
+                seen = true;
+            }
+            k += 1;
+            j = (2*j) % 255;
+        } while (j != i);
+
+        if (seen) {
+            continue;
+        }
+
+        // let M(x) = prod_j (x - g^j), M(x) has k <= 8 terms plus a
+        // leading 1
+        uint8_t m[9] = {0};
+        m[8] = 1;
+        j = i;
+        do {
+            uint8_t r[2] = {1, ramrsbd_gf_pow(RAMRSBD_GF_G, j)};
+            ramrsbd_gf_p_mul(
+                    m, 9,
+                    r, 2);
+            j = (2*j) % 255;
+        } while (j != i);
+
+        // let P(x) = P(x) M(x) / x^k
+        //
+        // P(x) always has at least k trailing zeros, so this is exact,
+        // and keeps the leading term of P(x) at x^8n
+        //
+        // note each bit only depends on more significant bits, so we can
+        // do this in place from the least significant bit up
+        for (lfs_size_t b = p_size; b-- > 0;) {
+            uint8_t x = 0;
+            for (lfs_size_t d = 0; d < k; d++) {
+                // minimal polynomials are binary
+                LFS_ASSERT(m[8-d] <= 1);
+
+                lfs_ssize_t b_ = (lfs_ssize_t)b - (lfs_ssize_t)(k-d);
+                if (m[8-d] && b_ >= -1) {
+                    // note b_ = -1 is the implied leading 1
+                    x ^= (b_ == -1) ? 1 : ramrsbd_bch_bit(p, b_);
+                }
+            }
+
+            if (x) {
+                ramrsbd_bch_flip(p, b);
+            }
+        }
+    }
+}
+
+// find the set of syndromes S for a codeword C(x)
+//
+// S_i = C(g^i) for 1 <= i <= 2t
+//
+// also returns true if zero for convenience
+static bool ramrsbd_bch_find_s(const ramrsbd_bch_t *bch, const uint8_t *c) {
+    lfs_size_t s_size = 2*bch->ecc_size;
+    memset(bch->s, 0, s_size);
+
+    // each set bit at x^d adds g^id to S_i, but we only need the odd
+    // syndromes here
+    LFS_ASSERT(!bch->plan || 8*bch->code_size <= bch->plan->size);
+    for (lfs_size_t b = 0; b < 8*bch->code_size; b++) {
+        if (!ramrsbd_bch_bit(c, b)) {
+            continue;
+        }
+
+        lfs_size_t k = 8*bch->code_size-1-b;
+        uint8_t x = (bch->plan)
+                ? bch->plan->x[k]
+                : ramrsbd_gf_pow(RAMRSBD_GF_G, k);
+        uint8_t xx = ramrsbd_gf_mul(x, x);
+        uint8_t y = x;
+        for (lfs_size_t i = 1; i < s_size; i += 2) {
+            // S_i lives at s[2t-i], which is what Berlekamp-Massey
+            // expects
+            bch->s[s_size-i] ^= y;
+            y = ramrsbd_gf_mul(y, xx);
+        }
+    }
+
+    // for binary codes, the even syndromes are free, S_2i = S_i^2
+    for (lfs_size_t i = 2; i <= s_size; i += 2) {
+        bch->s[s_size-i] = ramrsbd_gf_mul(
+                bch->s[s_size-i/2],
+                bch->s[s_size-i/2]);
+    }
+
+    // keep track of if we have any non-zero syndromes
+    for (lfs_size_t i = 0; i < s_size; i++) {
+        if (bch->s[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// find and repair errors in a codeword C(x), given the error-locator
+// Λ(x), returning the number of errors found
+//
+// binary errors always have magnitude 1, so we don't need Ω(x), and
+// repairing twice undoes the repair
+static lfs_size_t ramrsbd_bch_repair(const ramrsbd_bch_t *bch, uint8_t *c) {
+    // brute force search for error locations, this is any location
+    // X_j=g^j where X_j^-1 is a root of our error-locator, Λ(X_j^-1) = 0
+    LFS_ASSERT(!bch->plan || 8*bch->code_size <= bch->plan->size);
+    lfs_size_t n = 0;
+    for (lfs_size_t b = 0; b < 8*bch->code_size; b++) {
+        // let X_j^-1 = g^-j, which we only need in log form
+        lfs_size_t k = 8*bch->code_size-1-b;
+        uint16_t l = (bch->plan)
+                ? bch->plan->l[k]
+                : (255 - k) % 255;
+
+        // is X_j a root of our error-locator?
+        if (ramrsbd_gf_p_evall(
+                    bch->λ, 2*bch->ecc_size,
+                    l)
+                == 0) {
+            // found an error, now we can fix it!
+            ramrsbd_bch_flip(c, b);
+            n += 1;
+        }
+    }
+
+    return n;
+}
+
+// encode a codeword C(x) in place
+static void ramrsbd_bch_encode1(const ramrsbd_bch_t *bch, uint8_t *c) {
+    // let C(x) = M(x) x^n + (M(x) x^n mod P(x))
+    //
+    // P(x) is binary, so we can find the remainder a bit at a time,
+    // like a CRC
+    //
+    uint8_t *e = &c[bch->code_size-bch->ecc_size];
+    memset(e, 0, bch->ecc_size);
+
+    for (lfs_size_t b = 0; b < 8*(bch->code_size-bch->ecc_size); b++) {
+        uint8_t f = ramrsbd_bch_bit(c, b) ^ (e[0] >> 7);
+
+        // let E(x) = E(x) x
+        for (lfs_size_t j = 0; j < bch->ecc_size-1; j++) {
+            e[j] = (e[j] << 1) | (e[j+1] >> 7);
+        }
+        e[bch->ecc_size-1] <<= 1;
+
+        // and cancel the leading term with P(x)
+        if (f) {
+            for (lfs_size_t j = 0; j < bch->ecc_size; j++) {
+                e[j] ^= bch->p[j];
+            }
+        }
+    }
+}
+
+// decode a codeword C(x) in place, returning the number of errors
+// corrected, or -1 if uncorrectable
+static lfs_ssize_t ramrsbd_bch_decode1(const ramrsbd_bch_t *bch, uint8_t *c) {
+    // calculate syndromes
+    bool s_zero = ramrsbd_bch_find_s(bch, c);
+
+    // zero syndromes? no errors
+    if (s_zero) {
+        return 0;
+    }
+
+    // find the error-locator polynomial Λ(x), this is the same
+    // Berlekamp-Massey as Reed-Solomon, just with twice the syndromes
+    lfs_size_t n = ramrsbd_rs_find_λ(
+            bch->λ, 2*bch->ecc_size,
+            // use Ω(x) as scratch space
+            bch->ω, 2*bch->ecc_size,
+            bch->s, 2*bch->ecc_size);
+
+    // too many errors?
+    if (n > bch->ecc_size
+            || (bch->error_correction
+                && (lfs_ssize_t)n > bch->error_correction)) {
+        return -1;
+    }
+
+    // find and fix our errors, if we didn't find every root of Λ(x),
+    // there were too many errors
+    lfs_size_t found = ramrsbd_bch_repair(bch, c);
+    if (found != n) {
+        // undo our repair, so we don't make things worse
+        ramrsbd_bch_repair(bch, c);
+        return -1;
+    }
+
+    // calculate syndromes again to make sure we found all errors
+    s_zero = ramrsbd_bch_find_s(bch, c);
+    if (!s_zero) {
+        // undo our repair, so we don't make things worse
+        ramrsbd_bch_repair(bch, c);
+        return -1;
+    }
+
+    return n;
+}
+
+// Encode an array of codewords in place
+void ramrsbd_bch_encode(const ramrsbd_bch_t *bch,
+        void *buffer, lfs_size_t count) {
+    LFS_ASSERT(8*bch->code_size <= 255);
+
+    uint8_t *buffer_ = buffer;
+    for (lfs_size_t i = 0; i < count; i++) {
+        ramrsbd_bch_encode1(bch, &buffer_[i*bch->code_size]);
+    }
+}
+
+// Decode an array of codewords in place
+int ramrsbd_bch_decode(const ramrsbd_bch_t *bch,
+        void *buffer, lfs_size_t count, int8_t *results) {
+    LFS_ASSERT(8*bch->code_size <= 255);
+
+    uint8_t *buffer_ = buffer;
+    int err = 0;
+    for (lfs_size_t i = 0; i < count; i++) {
+        lfs_ssize_t n = ramrsbd_bch_decode1(bch,
+                &buffer_[i*bch->code_size]);
+        if (n < 0) {
+            err = LFS_ERR_CORRUPT;
+        }
+
+        if (results) {
+            results[i] = n;
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,92 @@
+/*
+ * Binary BCH encoding/decoding utilities
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef RAMRSBD_BCH_H
+#define RAMRSBD_BCH_H
+
+#include "lfs.h"
+#include "lfs_util.h"
+#include "ramrsbd_gf.h"
+#include "ramrsbd_gf_p.h"
+#include "ramrsbd_rs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Binary BCH codec
+//
+// Unlike Reed-Solomon, which corrects byte errors, binary BCH corrects
+// bit errors, up to ecc_size bit errors with ecc_size bytes of ecc.
+// This is a better fit for media dominated by scattered single-bit
+// errors.
+//
+// Codewords are polynomials over GF(2), one term per bit, so they are
+// limited to at most 255 bits, or 31 bytes.
+//
+// Like ramrsbd_rs_t, multiple codecs can share the same p, but each
+// thread decoding needs its own s, λ, and ω.
+typedef struct ramrsbd_bch {
+    // Size of a codeword in bytes, at most 31.
+    lfs_size_t code_size;
+
+    // Size of the error-correcting code in bytes.
+    lfs_size_t ecc_size;
+
+    // Number of bit errors to try to correct.
+    //
+    // By default, when zero, tries to correct as many errors as possible.
+    // -1 disables error correction and errors on any errors.
+    lfs_ssize_t error_correction;
+
+    // generator polynomial P(x) over GF(2), one bit per term, with
+    // implied leading 1, see ramrsbd_bch_p
+    const uint8_t *p; // ecc_size
+    // syndromes S_1..S_2t
+    uint8_t *s; // 2*ecc_size
+    // error-locator polynomial Λ(x)
+    uint8_t *λ; // 2*ecc_size
+    // scratch space for Berlekamp-Massey
+    uint8_t *ω; // 2*ecc_size
+
+    // Optional decode plan, with at least 8*code_size positions, see
+    // ramrsbd_rs_plan.
+    //
+    // By default, when NULL, these are computed as needed.
+    const ramrsbd_rs_plan_t *plan;
+} ramrsbd_bch_t;
+
+
+// Find the generator polynomial P(x) for ecc_size bytes of ecc
+//
+// P(x) has an implied leading 1, so p must be ecc_size.
+void ramrsbd_bch_p(uint8_t *p, lfs_size_t ecc_size);
+
+// Encode an array of contiguous codewords in place
+//
+// Each codeword is a code_size-ecc_size message followed by ecc_size
+// bytes of ecc, which are overwritten.
+void ramrsbd_bch_encode(const ramrsbd_bch_t *bch,
+        void *buffer, lfs_size_t count);
+
+// Decode an array of contiguous codewords in place
+//
+// If results is not NULL, the result for each codeword is written to
+// results[i]: 0 if clean, the number of bit errors corrected, or -1 if
+// uncorrectable. Uncorrectable codewords are left unmodified.
+//
+// Returns LFS_ERR_CORRUPT if any codeword is uncorrectable.
+int ramrsbd_bch_decode(const ramrsbd_bch_t *bch,
+        void *buffer, lfs_size_t count, int8_t *results);
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
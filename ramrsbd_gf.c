@@ -6,6 +6,185 @@
  */
 #include "ramrsbd_gf.h"
 
+#if defined(__GFNI__) && RAMRSBD_GF_P == 0x11b
+#include <immintrin.h>
+#endif
+
+
+#if RAMRSBD_GF_P == 0x11d && RAMRSBD_GF_G == 0x02
+#ifdef RAMRSBD_PROFILE_SPEED
+// generated by: ./gf-tables.py -s 0x11d 0x02
+
+// power table, RAMRSBD_GF_POW[x] = g^(x mod 255), or 0 for x >= 510
+const uint8_t RAMRSBD_GF_POW[1024] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+    0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26,
+    0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9,
+    0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0,
+    0x9d, 0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35,
+    0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23,
+    0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0,
+    0x5d, 0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1,
+    0x5f, 0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc,
+    0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0,
+    0xfd, 0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f,
+    0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2,
+    0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88,
+    0x0d, 0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce,
+    0x81, 0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93,
+    0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc,
+    0x85, 0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9,
+    0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54,
+    0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa,
+    0x49, 0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73,
+    0xe6, 0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e,
+    0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff,
+    0xe3, 0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4,
+    0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41,
+    0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e,
+    0x1c, 0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6,
+    0x51, 0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef,
+    0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09,
+    0x12, 0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5,
+    0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16,
+    0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83,
+    0x1b, 0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e, 0x01,
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d,
+    0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26, 0x4c,
+    0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9, 0x8f,
+    0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d,
+    0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35, 0x6a,
+    0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23, 0x46,
+    0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d,
+    0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1, 0x5f,
+    0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc, 0x65,
+    0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd,
+    0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f, 0xfe,
+    0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2, 0xd9,
+    0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d,
+    0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce, 0x81,
+    0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93, 0x3b,
+    0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85,
+    0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9, 0x4f,
+    0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54, 0xa8,
+    0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49,
+    0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73, 0xe6,
+    0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e, 0xfc,
+    0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3,
+    0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4, 0x95,
+    0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41, 0x82,
+    0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c,
+    0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6, 0x51,
+    0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef, 0xc3,
+    0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12,
+    0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5, 0xf7,
+    0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16, 0x2c,
+    0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b,
+    0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// log table, RAMRSBD_GF_LOG[x] = log_g x, or 510 for x = 0
+const uint16_t RAMRSBD_GF_LOG[256] = {
+    0x1fe, 0x000, 0x001, 0x019, 0x002, 0x032, 0x01a, 0x0c6,
+    0x003, 0x0df, 0x033, 0x0ee, 0x01b, 0x068, 0x0c7, 0x04b,
+    0x004, 0x064, 0x0e0, 0x00e, 0x034, 0x08d, 0x0ef, 0x081,
+    0x01c, 0x0c1, 0x069, 0x0f8, 0x0c8, 0x008, 0x04c, 0x071,
+    0x005, 0x08a, 0x065, 0x02f, 0x0e1, 0x024, 0x00f, 0x021,
+    0x035, 0x093, 0x08e, 0x0da, 0x0f0, 0x012, 0x082, 0x045,
+    0x01d, 0x0b5, 0x0c2, 0x07d, 0x06a, 0x027, 0x0f9, 0x0b9,
+    0x0c9, 0x09a, 0x009, 0x078, 0x04d, 0x0e4, 0x072, 0x0a6,
+    0x006, 0x0bf, 0x08b, 0x062, 0x066, 0x0dd, 0x030, 0x0fd,
+    0x0e2, 0x098, 0x025, 0x0b3, 0x010, 0x091, 0x022, 0x088,
+    0x036, 0x0d0, 0x094, 0x0ce, 0x08f, 0x096, 0x0db, 0x0bd,
+    0x0f1, 0x0d2, 0x013, 0x05c, 0x083, 0x038, 0x046, 0x040,
+    0x01e, 0x042, 0x0b6, 0x0a3, 0x0c3, 0x048, 0x07e, 0x06e,
+    0x06b, 0x03a, 0x028, 0x054, 0x0fa, 0x085, 0x0ba, 0x03d,
+    0x0ca, 0x05e, 0x09b, 0x09f, 0x00a, 0x015, 0x079, 0x02b,
+    0x04e, 0x0d4, 0x0e5, 0x0ac, 0x073, 0x0f3, 0x0a7, 0x057,
+    0x007, 0x070, 0x0c0, 0x0f7, 0x08c, 0x080, 0x063, 0x00d,
+    0x067, 0x04a, 0x0de, 0x0ed, 0x031, 0x0c5, 0x0fe, 0x018,
+    0x0e3, 0x0a5, 0x099, 0x077, 0x026, 0x0b8, 0x0b4, 0x07c,
+    0x011, 0x044, 0x092, 0x0d9, 0x023, 0x020, 0x089, 0x02e,
+    0x037, 0x03f, 0x0d1, 0x05b, 0x095, 0x0bc, 0x0cf, 0x0cd,
+    0x090, 0x087, 0x097, 0x0b2, 0x0dc, 0x0fc, 0x0be, 0x061,
+    0x0f2, 0x056, 0x0d3, 0x0ab, 0x014, 0x02a, 0x05d, 0x09e,
+    0x084, 0x03c, 0x039, 0x053, 0x047, 0x06d, 0x041, 0x0a2,
+    0x01f, 0x02d, 0x043, 0x0d8, 0x0b7, 0x07b, 0x0a4, 0x076,
+    0x0c4, 0x017, 0x049, 0x0ec, 0x07f, 0x00c, 0x06f, 0x0f6,
+    0x06c, 0x0a1, 0x03b, 0x052, 0x029, 0x09d, 0x055, 0x0aa,
+    0x0fb, 0x060, 0x086, 0x0b1, 0x0bb, 0x0cc, 0x03e, 0x05a,
+    0x0cb, 0x059, 0x05f, 0x0b0, 0x09c, 0x0a9, 0x0a0, 0x051,
+    0x00b, 0x0f5, 0x016, 0x0eb, 0x07a, 0x075, 0x02c, 0x0d7,
+    0x04f, 0x0ae, 0x0d5, 0x0e9, 0x0e6, 0x0e7, 0x0ad, 0x0e8,
+    0x074, 0x0d6, 0x0f4, 0x0ea, 0x0a8, 0x050, 0x058, 0x0af,
+};
+
+#else
+// generated by: ./gf-tables.py 0x11d 0x02
 
 // power table, RAMRSBD_GF_POW[x] = g^x
 static const uint8_t RAMRSBD_GF_POW[256] = {
@@ -79,9 +258,521 @@ static const uint8_t RAMRSBD_GF_LOG[256] = {
     0x74, 0xd6, 0xf4, 0xea, 0xa8, 0x50, 0x58, 0xaf,
 };
 
+#endif
+
+#elif RAMRSBD_GF_P == 0x11b && RAMRSBD_GF_G == 0x03
+#ifdef RAMRSBD_PROFILE_SPEED
+// generated by: ./gf-tables.py -s 0x11b 0x03
+
+// power table, RAMRSBD_GF_POW[x] = g^(x mod 255), or 0 for x >= 510
+const uint8_t RAMRSBD_GF_POW[1024] = {
+    0x01, 0x03, 0x05, 0x0f, 0x11, 0x33, 0x55, 0xff,
+    0x1a, 0x2e, 0x72, 0x96, 0xa1, 0xf8, 0x13, 0x35,
+    0x5f, 0xe1, 0x38, 0x48, 0xd8, 0x73, 0x95, 0xa4,
+    0xf7, 0x02, 0x06, 0x0a, 0x1e, 0x22, 0x66, 0xaa,
+    0xe5, 0x34, 0x5c, 0xe4, 0x37, 0x59, 0xeb, 0x26,
+    0x6a, 0xbe, 0xd9, 0x70, 0x90, 0xab, 0xe6, 0x31,
+    0x53, 0xf5, 0x04, 0x0c, 0x14, 0x3c, 0x44, 0xcc,
+    0x4f, 0xd1, 0x68, 0xb8, 0xd3, 0x6e, 0xb2, 0xcd,
+    0x4c, 0xd4, 0x67, 0xa9, 0xe0, 0x3b, 0x4d, 0xd7,
+    0x62, 0xa6, 0xf1, 0x08, 0x18, 0x28, 0x78, 0x88,
+    0x83, 0x9e, 0xb9, 0xd0, 0x6b, 0xbd, 0xdc, 0x7f,
+    0x81, 0x98, 0xb3, 0xce, 0x49, 0xdb, 0x76, 0x9a,
+    0xb5, 0xc4, 0x57, 0xf9, 0x10, 0x30, 0x50, 0xf0,
+    0x0b, 0x1d, 0x27, 0x69, 0xbb, 0xd6, 0x61, 0xa3,
+    0xfe, 0x19, 0x2b, 0x7d, 0x87, 0x92, 0xad, 0xec,
+    0x2f, 0x71, 0x93, 0xae, 0xe9, 0x20, 0x60, 0xa0,
+    0xfb, 0x16, 0x3a, 0x4e, 0xd2, 0x6d, 0xb7, 0xc2,
+    0x5d, 0xe7, 0x32, 0x56, 0xfa, 0x15, 0x3f, 0x41,
+    0xc3, 0x5e, 0xe2, 0x3d, 0x47, 0xc9, 0x40, 0xc0,
+    0x5b, 0xed, 0x2c, 0x74, 0x9c, 0xbf, 0xda, 0x75,
+    0x9f, 0xba, 0xd5, 0x64, 0xac, 0xef, 0x2a, 0x7e,
+    0x82, 0x9d, 0xbc, 0xdf, 0x7a, 0x8e, 0x89, 0x80,
+    0x9b, 0xb6, 0xc1, 0x58, 0xe8, 0x23, 0x65, 0xaf,
+    0xea, 0x25, 0x6f, 0xb1, 0xc8, 0x43, 0xc5, 0x54,
+    0xfc, 0x1f, 0x21, 0x63, 0xa5, 0xf4, 0x07, 0x09,
+    0x1b, 0x2d, 0x77, 0x99, 0xb0, 0xcb, 0x46, 0xca,
+    0x45, 0xcf, 0x4a, 0xde, 0x79, 0x8b, 0x86, 0x91,
+    0xa8, 0xe3, 0x3e, 0x42, 0xc6, 0x51, 0xf3, 0x0e,
+    0x12, 0x36, 0x5a, 0xee, 0x29, 0x7b, 0x8d, 0x8c,
+    0x8f, 0x8a, 0x85, 0x94, 0xa7, 0xf2, 0x0d, 0x17,
+    0x39, 0x4b, 0xdd, 0x7c, 0x84, 0x97, 0xa2, 0xfd,
+    0x1c, 0x24, 0x6c, 0xb4, 0xc7, 0x52, 0xf6, 0x01,
+    0x03, 0x05, 0x0f, 0x11, 0x33, 0x55, 0xff, 0x1a,
+    0x2e, 0x72, 0x96, 0xa1, 0xf8, 0x13, 0x35, 0x5f,
+    0xe1, 0x38, 0x48, 0xd8, 0x73, 0x95, 0xa4, 0xf7,
+    0x02, 0x06, 0x0a, 0x1e, 0x22, 0x66, 0xaa, 0xe5,
+    0x34, 0x5c, 0xe4, 0x37, 0x59, 0xeb, 0x26, 0x6a,
+    0xbe, 0xd9, 0x70, 0x90, 0xab, 0xe6, 0x31, 0x53,
+    0xf5, 0x04, 0x0c, 0x14, 0x3c, 0x44, 0xcc, 0x4f,
+    0xd1, 0x68, 0xb8, 0xd3, 0x6e, 0xb2, 0xcd, 0x4c,
+    0xd4, 0x67, 0xa9, 0xe0, 0x3b, 0x4d, 0xd7, 0x62,
+    0xa6, 0xf1, 0x08, 0x18, 0x28, 0x78, 0x88, 0x83,
+    0x9e, 0xb9, 0xd0, 0x6b, 0xbd, 0xdc, 0x7f, 0x81,
+    0x98, 0xb3, 0xce, 0x49, 0xdb, 0x76, 0x9a, 0xb5,
+    0xc4, 0x57, 0xf9, 0x10, 0x30, 0x50, 0xf0, 0x0b,
+    0x1d, 0x27, 0x69, 0xbb, 0xd6, 0x61, 0xa3, 0xfe,
+    0x19, 0x2b, 0x7d, 0x87, 0x92, 0xad, 0xec, 0x2f,
+    0x71, 0x93, 0xae, 0xe9, 0x20, 0x60, 0xa0, 0xfb,
+    0x16, 0x3a, 0x4e, 0xd2, 0x6d, 0xb7, 0xc2, 0x5d,
+    0xe7, 0x32, 0x56, 0xfa, 0x15, 0x3f, 0x41, 0xc3,
+    0x5e, 0xe2, 0x3d, 0x47, 0xc9, 0x40, 0xc0, 0x5b,
+    0xed, 0x2c, 0x74, 0x9c, 0xbf, 0xda, 0x75, 0x9f,
+    0xba, 0xd5, 0x64, 0xac, 0xef, 0x2a, 0x7e, 0x82,
+    0x9d, 0xbc, 0xdf, 0x7a, 0x8e, 0x89, 0x80, 0x9b,
+    0xb6, 0xc1, 0x58, 0xe8, 0x23, 0x65, 0xaf, 0xea,
+    0x25, 0x6f, 0xb1, 0xc8, 0x43, 0xc5, 0x54, 0xfc,
+    0x1f, 0x21, 0x63, 0xa5, 0xf4, 0x07, 0x09, 0x1b,
+    0x2d, 0x77, 0x99, 0xb0, 0xcb, 0x46, 0xca, 0x45,
+    0xcf, 0x4a, 0xde, 0x79, 0x8b, 0x86, 0x91, 0xa8,
+    0xe3, 0x3e, 0x42, 0xc6, 0x51, 0xf3, 0x0e, 0x12,
+    0x36, 0x5a, 0xee, 0x29, 0x7b, 0x8d, 0x8c, 0x8f,
+    0x8a, 0x85, 0x94, 0xa7, 0xf2, 0x0d, 0x17, 0x39,
+    0x4b, 0xdd, 0x7c, 0x84, 0x97, 0xa2, 0xfd, 0x1c,
+    0x24, 0x6c, 0xb4, 0xc7, 0x52, 0xf6, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// log table, RAMRSBD_GF_LOG[x] = log_g x, or 510 for x = 0
+const uint16_t RAMRSBD_GF_LOG[256] = {
+    0x1fe, 0x000, 0x019, 0x001, 0x032, 0x002, 0x01a, 0x0c6,
+    0x04b, 0x0c7, 0x01b, 0x068, 0x033, 0x0ee, 0x0df, 0x003,
+    0x064, 0x004, 0x0e0, 0x00e, 0x034, 0x08d, 0x081, 0x0ef,
+    0x04c, 0x071, 0x008, 0x0c8, 0x0f8, 0x069, 0x01c, 0x0c1,
+    0x07d, 0x0c2, 0x01d, 0x0b5, 0x0f9, 0x0b9, 0x027, 0x06a,
+    0x04d, 0x0e4, 0x0a6, 0x072, 0x09a, 0x0c9, 0x009, 0x078,
+    0x065, 0x02f, 0x08a, 0x005, 0x021, 0x00f, 0x0e1, 0x024,
+    0x012, 0x0f0, 0x082, 0x045, 0x035, 0x093, 0x0da, 0x08e,
+    0x096, 0x08f, 0x0db, 0x0bd, 0x036, 0x0d0, 0x0ce, 0x094,
+    0x013, 0x05c, 0x0d2, 0x0f1, 0x040, 0x046, 0x083, 0x038,
+    0x066, 0x0dd, 0x0fd, 0x030, 0x0bf, 0x006, 0x08b, 0x062,
+    0x0b3, 0x025, 0x0e2, 0x098, 0x022, 0x088, 0x091, 0x010,
+    0x07e, 0x06e, 0x048, 0x0c3, 0x0a3, 0x0b6, 0x01e, 0x042,
+    0x03a, 0x06b, 0x028, 0x054, 0x0fa, 0x085, 0x03d, 0x0ba,
+    0x02b, 0x079, 0x00a, 0x015, 0x09b, 0x09f, 0x05e, 0x0ca,
+    0x04e, 0x0d4, 0x0ac, 0x0e5, 0x0f3, 0x073, 0x0a7, 0x057,
+    0x0af, 0x058, 0x0a8, 0x050, 0x0f4, 0x0ea, 0x0d6, 0x074,
+    0x04f, 0x0ae, 0x0e9, 0x0d5, 0x0e7, 0x0e6, 0x0ad, 0x0e8,
+    0x02c, 0x0d7, 0x075, 0x07a, 0x0eb, 0x016, 0x00b, 0x0f5,
+    0x059, 0x0cb, 0x05f, 0x0b0, 0x09c, 0x0a9, 0x051, 0x0a0,
+    0x07f, 0x00c, 0x0f6, 0x06f, 0x017, 0x0c4, 0x049, 0x0ec,
+    0x0d8, 0x043, 0x01f, 0x02d, 0x0a4, 0x076, 0x07b, 0x0b7,
+    0x0cc, 0x0bb, 0x03e, 0x05a, 0x0fb, 0x060, 0x0b1, 0x086,
+    0x03b, 0x052, 0x0a1, 0x06c, 0x0aa, 0x055, 0x029, 0x09d,
+    0x097, 0x0b2, 0x087, 0x090, 0x061, 0x0be, 0x0dc, 0x0fc,
+    0x0bc, 0x095, 0x0cf, 0x0cd, 0x037, 0x03f, 0x05b, 0x0d1,
+    0x053, 0x039, 0x084, 0x03c, 0x041, 0x0a2, 0x06d, 0x047,
+    0x014, 0x02a, 0x09e, 0x05d, 0x056, 0x0f2, 0x0d3, 0x0ab,
+    0x044, 0x011, 0x092, 0x0d9, 0x023, 0x020, 0x02e, 0x089,
+    0x0b4, 0x07c, 0x0b8, 0x026, 0x077, 0x099, 0x0e3, 0x0a5,
+    0x067, 0x04a, 0x0ed, 0x0de, 0x0c5, 0x031, 0x0fe, 0x018,
+    0x00d, 0x063, 0x08c, 0x080, 0x0c0, 0x0f7, 0x070, 0x007,
+};
+
+#else
+// generated by: ./gf-tables.py 0x11b 0x03
+
+// power table, RAMRSBD_GF_POW[x] = g^x
+static const uint8_t RAMRSBD_GF_POW[256] = {
+    0x01, 0x03, 0x05, 0x0f, 0x11, 0x33, 0x55, 0xff,
+    0x1a, 0x2e, 0x72, 0x96, 0xa1, 0xf8, 0x13, 0x35,
+    0x5f, 0xe1, 0x38, 0x48, 0xd8, 0x73, 0x95, 0xa4,
+    0xf7, 0x02, 0x06, 0x0a, 0x1e, 0x22, 0x66, 0xaa,
+    0xe5, 0x34, 0x5c, 0xe4, 0x37, 0x59, 0xeb, 0x26,
+    0x6a, 0xbe, 0xd9, 0x70, 0x90, 0xab, 0xe6, 0x31,
+    0x53, 0xf5, 0x04, 0x0c, 0x14, 0x3c, 0x44, 0xcc,
+    0x4f, 0xd1, 0x68, 0xb8, 0xd3, 0x6e, 0xb2, 0xcd,
+    0x4c, 0xd4, 0x67, 0xa9, 0xe0, 0x3b, 0x4d, 0xd7,
+    0x62, 0xa6, 0xf1, 0x08, 0x18, 0x28, 0x78, 0x88,
+    0x83, 0x9e, 0xb9, 0xd0, 0x6b, 0xbd, 0xdc, 0x7f,
+    0x81, 0x98, 0xb3, 0xce, 0x49, 0xdb, 0x76, 0x9a,
+    0xb5, 0xc4, 0x57, 0xf9, 0x10, 0x30, 0x50, 0xf0,
+    0x0b, 0x1d, 0x27, 0x69, 0xbb, 0xd6, 0x61, 0xa3,
+    0xfe, 0x19, 0x2b, 0x7d, 0x87, 0x92, 0xad, 0xec,
+    0x2f, 0x71, 0x93, 0xae, 0xe9, 0x20, 0x60, 0xa0,
+    0xfb, 0x16, 0x3a, 0x4e, 0xd2, 0x6d, 0xb7, 0xc2,
+    0x5d, 0xe7, 0x32, 0x56, 0xfa, 0x15, 0x3f, 0x41,
+    0xc3, 0x5e, 0xe2, 0x3d, 0x47, 0xc9, 0x40, 0xc0,
+    0x5b, 0xed, 0x2c, 0x74, 0x9c, 0xbf, 0xda, 0x75,
+    0x9f, 0xba, 0xd5, 0x64, 0xac, 0xef, 0x2a, 0x7e,
+    0x82, 0x9d, 0xbc, 0xdf, 0x7a, 0x8e, 0x89, 0x80,
+    0x9b, 0xb6, 0xc1, 0x58, 0xe8, 0x23, 0x65, 0xaf,
+    0xea, 0x25, 0x6f, 0xb1, 0xc8, 0x43, 0xc5, 0x54,
+    0xfc, 0x1f, 0x21, 0x63, 0xa5, 0xf4, 0x07, 0x09,
+    0x1b, 0x2d, 0x77, 0x99, 0xb0, 0xcb, 0x46, 0xca,
+    0x45, 0xcf, 0x4a, 0xde, 0x79, 0x8b, 0x86, 0x91,
+    0xa8, 0xe3, 0x3e, 0x42, 0xc6, 0x51, 0xf3, 0x0e,
+    0x12, 0x36, 0x5a, 0xee, 0x29, 0x7b, 0x8d, 0x8c,
+    0x8f, 0x8a, 0x85, 0x94, 0xa7, 0xf2, 0x0d, 0x17,
+    0x39, 0x4b, 0xdd, 0x7c, 0x84, 0x97, 0xa2, 0xfd,
+    0x1c, 0x24, 0x6c, 0xb4, 0xc7, 0x52, 0xf6, 0x01,
+};
+
+// log table, RAMRSBD_GF_LOG[x] = log_g x
+static const uint8_t RAMRSBD_GF_LOG[256] = {
+    0xff, 0x00, 0x19, 0x01, 0x32, 0x02, 0x1a, 0xc6,
+    0x4b, 0xc7, 0x1b, 0x68, 0x33, 0xee, 0xdf, 0x03,
+    0x64, 0x04, 0xe0, 0x0e, 0x34, 0x8d, 0x81, 0xef,
+    0x4c, 0x71, 0x08, 0xc8, 0xf8, 0x69, 0x1c, 0xc1,
+    0x7d, 0xc2, 0x1d, 0xb5, 0xf9, 0xb9, 0x27, 0x6a,
+    0x4d, 0xe4, 0xa6, 0x72, 0x9a, 0xc9, 0x09, 0x78,
+    0x65, 0x2f, 0x8a, 0x05, 0x21, 0x0f, 0xe1, 0x24,
+    0x12, 0xf0, 0x82, 0x45, 0x35, 0x93, 0xda, 0x8e,
+    0x96, 0x8f, 0xdb, 0xbd, 0x36, 0xd0, 0xce, 0x94,
+    0x13, 0x5c, 0xd2, 0xf1, 0x40, 0x46, 0x83, 0x38,
+    0x66, 0xdd, 0xfd, 0x30, 0xbf, 0x06, 0x8b, 0x62,
+    0xb3, 0x25, 0xe2, 0x98, 0x22, 0x88, 0x91, 0x10,
+    0x7e, 0x6e, 0x48, 0xc3, 0xa3, 0xb6, 0x1e, 0x42,
+    0x3a, 0x6b, 0x28, 0x54, 0xfa, 0x85, 0x3d, 0xba,
+    0x2b, 0x79, 0x0a, 0x15, 0x9b, 0x9f, 0x5e, 0xca,
+    0x4e, 0xd4, 0xac, 0xe5, 0xf3, 0x73, 0xa7, 0x57,
+    0xaf, 0x58, 0xa8, 0x50, 0xf4, 0xea, 0xd6, 0x74,
+    0x4f, 0xae, 0xe9, 0xd5, 0xe7, 0xe6, 0xad, 0xe8,
+    0x2c, 0xd7, 0x75, 0x7a, 0xeb, 0x16, 0x0b, 0xf5,
+    0x59, 0xcb, 0x5f, 0xb0, 0x9c, 0xa9, 0x51, 0xa0,
+    0x7f, 0x0c, 0xf6, 0x6f, 0x17, 0xc4, 0x49, 0xec,
+    0xd8, 0x43, 0x1f, 0x2d, 0xa4, 0x76, 0x7b, 0xb7,
+    0xcc, 0xbb, 0x3e, 0x5a, 0xfb, 0x60, 0xb1, 0x86,
+    0x3b, 0x52, 0xa1, 0x6c, 0xaa, 0x55, 0x29, 0x9d,
+    0x97, 0xb2, 0x87, 0x90, 0x61, 0xbe, 0xdc, 0xfc,
+    0xbc, 0x95, 0xcf, 0xcd, 0x37, 0x3f, 0x5b, 0xd1,
+    0x53, 0x39, 0x84, 0x3c, 0x41, 0xa2, 0x6d, 0x47,
+    0x14, 0x2a, 0x9e, 0x5d, 0x56, 0xf2, 0xd3, 0xab,
+    0x44, 0x11, 0x92, 0xd9, 0x23, 0x20, 0x2e, 0x89,
+    0xb4, 0x7c, 0xb8, 0x26, 0x77, 0x99, 0xe3, 0xa5,
+    0x67, 0x4a, 0xed, 0xde, 0xc5, 0x31, 0xfe, 0x18,
+    0x0d, 0x63, 0x8c, 0x80, 0xc0, 0xf7, 0x70, 0x07,
+};
+
+#endif
 
+#elif RAMRSBD_GF_P == 0x12d && RAMRSBD_GF_G == 0x02
+#ifdef RAMRSBD_PROFILE_SPEED
+// generated by: ./gf-tables.py -s 0x12d 0x02
+
+// power table, RAMRSBD_GF_POW[x] = g^(x mod 255), or 0 for x >= 510
+const uint8_t RAMRSBD_GF_POW[1024] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+    0x2d, 0x5a, 0xb4, 0x45, 0x8a, 0x39, 0x72, 0xe4,
+    0xe5, 0xe7, 0xe3, 0xeb, 0xfb, 0xdb, 0x9b, 0x1b,
+    0x36, 0x6c, 0xd8, 0x9d, 0x17, 0x2e, 0x5c, 0xb8,
+    0x5d, 0xba, 0x59, 0xb2, 0x49, 0x92, 0x09, 0x12,
+    0x24, 0x48, 0x90, 0x0d, 0x1a, 0x34, 0x68, 0xd0,
+    0x8d, 0x37, 0x6e, 0xdc, 0x95, 0x07, 0x0e, 0x1c,
+    0x38, 0x70, 0xe0, 0xed, 0xf7, 0xc3, 0xab, 0x7b,
+    0xf6, 0xc1, 0xaf, 0x73, 0xe6, 0xe1, 0xef, 0xf3,
+    0xcb, 0xbb, 0x5b, 0xb6, 0x41, 0x82, 0x29, 0x52,
+    0xa4, 0x65, 0xca, 0xb9, 0x5f, 0xbe, 0x51, 0xa2,
+    0x69, 0xd2, 0x89, 0x3f, 0x7e, 0xfc, 0xd5, 0x87,
+    0x23, 0x46, 0x8c, 0x35, 0x6a, 0xd4, 0x85, 0x27,
+    0x4e, 0x9c, 0x15, 0x2a, 0x54, 0xa8, 0x7d, 0xfa,
+    0xd9, 0x9f, 0x13, 0x26, 0x4c, 0x98, 0x1d, 0x3a,
+    0x74, 0xe8, 0xfd, 0xd7, 0x83, 0x2b, 0x56, 0xac,
+    0x75, 0xea, 0xf9, 0xdf, 0x93, 0x0b, 0x16, 0x2c,
+    0x58, 0xb0, 0x4d, 0x9a, 0x19, 0x32, 0x64, 0xc8,
+    0xbd, 0x57, 0xae, 0x71, 0xe2, 0xe9, 0xff, 0xd3,
+    0x8b, 0x3b, 0x76, 0xec, 0xf5, 0xc7, 0xa3, 0x6b,
+    0xd6, 0x81, 0x2f, 0x5e, 0xbc, 0x55, 0xaa, 0x79,
+    0xf2, 0xc9, 0xbf, 0x53, 0xa6, 0x61, 0xc2, 0xa9,
+    0x7f, 0xfe, 0xd1, 0x8f, 0x33, 0x66, 0xcc, 0xb5,
+    0x47, 0x8e, 0x31, 0x62, 0xc4, 0xa5, 0x67, 0xce,
+    0xb1, 0x4f, 0x9e, 0x11, 0x22, 0x44, 0x88, 0x3d,
+    0x7a, 0xf4, 0xc5, 0xa7, 0x63, 0xc6, 0xa1, 0x6f,
+    0xde, 0x91, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xcd,
+    0xb7, 0x43, 0x86, 0x21, 0x42, 0x84, 0x25, 0x4a,
+    0x94, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x6d,
+    0xda, 0x99, 0x1f, 0x3e, 0x7c, 0xf8, 0xdd, 0x97,
+    0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0xad,
+    0x77, 0xee, 0xf1, 0xcf, 0xb3, 0x4b, 0x96, 0x01,
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x2d,
+    0x5a, 0xb4, 0x45, 0x8a, 0x39, 0x72, 0xe4, 0xe5,
+    0xe7, 0xe3, 0xeb, 0xfb, 0xdb, 0x9b, 0x1b, 0x36,
+    0x6c, 0xd8, 0x9d, 0x17, 0x2e, 0x5c, 0xb8, 0x5d,
+    0xba, 0x59, 0xb2, 0x49, 0x92, 0x09, 0x12, 0x24,
+    0x48, 0x90, 0x0d, 0x1a, 0x34, 0x68, 0xd0, 0x8d,
+    0x37, 0x6e, 0xdc, 0x95, 0x07, 0x0e, 0x1c, 0x38,
+    0x70, 0xe0, 0xed, 0xf7, 0xc3, 0xab, 0x7b, 0xf6,
+    0xc1, 0xaf, 0x73, 0xe6, 0xe1, 0xef, 0xf3, 0xcb,
+    0xbb, 0x5b, 0xb6, 0x41, 0x82, 0x29, 0x52, 0xa4,
+    0x65, 0xca, 0xb9, 0x5f, 0xbe, 0x51, 0xa2, 0x69,
+    0xd2, 0x89, 0x3f, 0x7e, 0xfc, 0xd5, 0x87, 0x23,
+    0x46, 0x8c, 0x35, 0x6a, 0xd4, 0x85, 0x27, 0x4e,
+    0x9c, 0x15, 0x2a, 0x54, 0xa8, 0x7d, 0xfa, 0xd9,
+    0x9f, 0x13, 0x26, 0x4c, 0x98, 0x1d, 0x3a, 0x74,
+    0xe8, 0xfd, 0xd7, 0x83, 0x2b, 0x56, 0xac, 0x75,
+    0xea, 0xf9, 0xdf, 0x93, 0x0b, 0x16, 0x2c, 0x58,
+    0xb0, 0x4d, 0x9a, 0x19, 0x32, 0x64, 0xc8, 0xbd,
+    0x57, 0xae, 0x71, 0xe2, 0xe9, 0xff, 0xd3, 0x8b,
+    0x3b, 0x76, 0xec, 0xf5, 0xc7, 0xa3, 0x6b, 0xd6,
+    0x81, 0x2f, 0x5e, 0xbc, 0x55, 0xaa, 0x79, 0xf2,
+    0xc9, 0xbf, 0x53, 0xa6, 0x61, 0xc2, 0xa9, 0x7f,
+    0xfe, 0xd1, 0x8f, 0x33, 0x66, 0xcc, 0xb5, 0x47,
+    0x8e, 0x31, 0x62, 0xc4, 0xa5, 0x67, 0xce, 0xb1,
+    0x4f, 0x9e, 0x11, 0x22, 0x44, 0x88, 0x3d, 0x7a,
+    0xf4, 0xc5, 0xa7, 0x63, 0xc6, 0xa1, 0x6f, 0xde,
+    0x91, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xcd, 0xb7,
+    0x43, 0x86, 0x21, 0x42, 0x84, 0x25, 0x4a, 0x94,
+    0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x6d, 0xda,
+    0x99, 0x1f, 0x3e, 0x7c, 0xf8, 0xdd, 0x97, 0x03,
+    0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0xad, 0x77,
+    0xee, 0xf1, 0xcf, 0xb3, 0x4b, 0x96, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// log table, RAMRSBD_GF_LOG[x] = log_g x, or 510 for x = 0
+const uint16_t RAMRSBD_GF_LOG[256] = {
+    0x1fe, 0x000, 0x001, 0x0f0, 0x002, 0x0e1, 0x0f1, 0x035,
+    0x003, 0x026, 0x0e2, 0x085, 0x0f2, 0x02b, 0x036, 0x0d2,
+    0x004, 0x0c3, 0x027, 0x072, 0x0e3, 0x06a, 0x086, 0x01c,
+    0x0f3, 0x08c, 0x02c, 0x017, 0x037, 0x076, 0x0d3, 0x0ea,
+    0x005, 0x0db, 0x0c4, 0x060, 0x028, 0x0de, 0x073, 0x067,
+    0x0e4, 0x04e, 0x06b, 0x07d, 0x087, 0x008, 0x01d, 0x0a2,
+    0x0f4, 0x0ba, 0x08d, 0x0b4, 0x02d, 0x063, 0x018, 0x031,
+    0x038, 0x00d, 0x077, 0x099, 0x0d4, 0x0c7, 0x0eb, 0x05b,
+    0x006, 0x04c, 0x0dc, 0x0d9, 0x0c5, 0x00b, 0x061, 0x0b8,
+    0x029, 0x024, 0x0df, 0x0fd, 0x074, 0x08a, 0x068, 0x0c1,
+    0x0e5, 0x056, 0x04f, 0x0ab, 0x06c, 0x0a5, 0x07e, 0x091,
+    0x088, 0x022, 0x009, 0x04a, 0x01e, 0x020, 0x0a3, 0x054,
+    0x0f5, 0x0ad, 0x0bb, 0x0cc, 0x08e, 0x051, 0x0b5, 0x0be,
+    0x02e, 0x058, 0x064, 0x09f, 0x019, 0x0e7, 0x032, 0x0cf,
+    0x039, 0x093, 0x00e, 0x043, 0x078, 0x080, 0x09a, 0x0f8,
+    0x0d5, 0x0a7, 0x0c8, 0x03f, 0x0ec, 0x06e, 0x05c, 0x0b0,
+    0x007, 0x0a1, 0x04d, 0x07c, 0x0dd, 0x066, 0x0da, 0x05f,
+    0x0c6, 0x05a, 0x00c, 0x098, 0x062, 0x030, 0x0b9, 0x0b3,
+    0x02a, 0x0d1, 0x025, 0x084, 0x0e0, 0x034, 0x0fe, 0x0ef,
+    0x075, 0x0e9, 0x08b, 0x016, 0x069, 0x01b, 0x0c2, 0x071,
+    0x0e6, 0x0ce, 0x057, 0x09e, 0x050, 0x0bd, 0x0ac, 0x0cb,
+    0x06d, 0x0af, 0x0a6, 0x03e, 0x07f, 0x0f7, 0x092, 0x042,
+    0x089, 0x0c0, 0x023, 0x0fc, 0x00a, 0x0b7, 0x04b, 0x0d8,
+    0x01f, 0x053, 0x021, 0x049, 0x0a4, 0x090, 0x055, 0x0aa,
+    0x0f6, 0x041, 0x0ae, 0x03d, 0x0bc, 0x0ca, 0x0cd, 0x09d,
+    0x08f, 0x0a9, 0x052, 0x048, 0x0b6, 0x0d7, 0x0bf, 0x0fb,
+    0x02f, 0x0b2, 0x059, 0x097, 0x065, 0x05e, 0x0a0, 0x07b,
+    0x01a, 0x070, 0x0e8, 0x015, 0x033, 0x0ee, 0x0d0, 0x083,
+    0x03a, 0x045, 0x094, 0x012, 0x00f, 0x010, 0x044, 0x011,
+    0x079, 0x095, 0x081, 0x013, 0x09b, 0x03b, 0x0f9, 0x046,
+    0x0d6, 0x0fa, 0x0a8, 0x047, 0x0c9, 0x09c, 0x040, 0x03c,
+    0x0ed, 0x082, 0x06f, 0x014, 0x05d, 0x07a, 0x0b1, 0x096,
+};
+
+#else
+// generated by: ./gf-tables.py 0x12d 0x02
+
+// power table, RAMRSBD_GF_POW[x] = g^x
+static const uint8_t RAMRSBD_GF_POW[256] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+    0x2d, 0x5a, 0xb4, 0x45, 0x8a, 0x39, 0x72, 0xe4,
+    0xe5, 0xe7, 0xe3, 0xeb, 0xfb, 0xdb, 0x9b, 0x1b,
+    0x36, 0x6c, 0xd8, 0x9d, 0x17, 0x2e, 0x5c, 0xb8,
+    0x5d, 0xba, 0x59, 0xb2, 0x49, 0x92, 0x09, 0x12,
+    0x24, 0x48, 0x90, 0x0d, 0x1a, 0x34, 0x68, 0xd0,
+    0x8d, 0x37, 0x6e, 0xdc, 0x95, 0x07, 0x0e, 0x1c,
+    0x38, 0x70, 0xe0, 0xed, 0xf7, 0xc3, 0xab, 0x7b,
+    0xf6, 0xc1, 0xaf, 0x73, 0xe6, 0xe1, 0xef, 0xf3,
+    0xcb, 0xbb, 0x5b, 0xb6, 0x41, 0x82, 0x29, 0x52,
+    0xa4, 0x65, 0xca, 0xb9, 0x5f, 0xbe, 0x51, 0xa2,
+    0x69, 0xd2, 0x89, 0x3f, 0x7e, 0xfc, 0xd5, 0x87,
+    0x23, 0x46, 0x8c, 0x35, 0x6a, 0xd4, 0x85, 0x27,
+    0x4e, 0x9c, 0x15, 0x2a, 0x54, 0xa8, 0x7d, 0xfa,
+    0xd9, 0x9f, 0x13, 0x26, 0x4c, 0x98, 0x1d, 0x3a,
+    0x74, 0xe8, 0xfd, 0xd7, 0x83, 0x2b, 0x56, 0xac,
+    0x75, 0xea, 0xf9, 0xdf, 0x93, 0x0b, 0x16, 0x2c,
+    0x58, 0xb0, 0x4d, 0x9a, 0x19, 0x32, 0x64, 0xc8,
+    0xbd, 0x57, 0xae, 0x71, 0xe2, 0xe9, 0xff, 0xd3,
+    0x8b, 0x3b, 0x76, 0xec, 0xf5, 0xc7, 0xa3, 0x6b,
+    0xd6, 0x81, 0x2f, 0x5e, 0xbc, 0x55, 0xaa, 0x79,
+    0xf2, 0xc9, 0xbf, 0x53, 0xa6, 0x61, 0xc2, 0xa9,
+    0x7f, 0xfe, 0xd1, 0x8f, 0x33, 0x66, 0xcc, 0xb5,
+    0x47, 0x8e, 0x31, 0x62, 0xc4, 0xa5, 0x67, 0xce,
+    0xb1, 0x4f, 0x9e, 0x11, 0x22, 0x44, 0x88, 0x3d,
+    0x7a, 0xf4, 0xc5, 0xa7, 0x63, 0xc6, 0xa1, 0x6f,
+    0xde, 0x91, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xcd,
+    0xb7, 0x43, 0x86, 0x21, 0x42, 0x84, 0x25, 0x4a,
+    0x94, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x6d,
+    0xda, 0x99, 0x1f, 0x3e, 0x7c, 0xf8, 0xdd, 0x97,
+    0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0xad,
+    0x77, 0xee, 0xf1, 0xcf, 0xb3, 0x4b, 0x96, 0x01,
+};
+
+// log table, RAMRSBD_GF_LOG[x] = log_g x
+static const uint8_t RAMRSBD_GF_LOG[256] = {
+    0xff, 0x00, 0x01, 0xf0, 0x02, 0xe1, 0xf1, 0x35,
+    0x03, 0x26, 0xe2, 0x85, 0xf2, 0x2b, 0x36, 0xd2,
+    0x04, 0xc3, 0x27, 0x72, 0xe3, 0x6a, 0x86, 0x1c,
+    0xf3, 0x8c, 0x2c, 0x17, 0x37, 0x76, 0xd3, 0xea,
+    0x05, 0xdb, 0xc4, 0x60, 0x28, 0xde, 0x73, 0x67,
+    0xe4, 0x4e, 0x6b, 0x7d, 0x87, 0x08, 0x1d, 0xa2,
+    0xf4, 0xba, 0x8d, 0xb4, 0x2d, 0x63, 0x18, 0x31,
+    0x38, 0x0d, 0x77, 0x99, 0xd4, 0xc7, 0xeb, 0x5b,
+    0x06, 0x4c, 0xdc, 0xd9, 0xc5, 0x0b, 0x61, 0xb8,
+    0x29, 0x24, 0xdf, 0xfd, 0x74, 0x8a, 0x68, 0xc1,
+    0xe5, 0x56, 0x4f, 0xab, 0x6c, 0xa5, 0x7e, 0x91,
+    0x88, 0x22, 0x09, 0x4a, 0x1e, 0x20, 0xa3, 0x54,
+    0xf5, 0xad, 0xbb, 0xcc, 0x8e, 0x51, 0xb5, 0xbe,
+    0x2e, 0x58, 0x64, 0x9f, 0x19, 0xe7, 0x32, 0xcf,
+    0x39, 0x93, 0x0e, 0x43, 0x78, 0x80, 0x9a, 0xf8,
+    0xd5, 0xa7, 0xc8, 0x3f, 0xec, 0x6e, 0x5c, 0xb0,
+    0x07, 0xa1, 0x4d, 0x7c, 0xdd, 0x66, 0xda, 0x5f,
+    0xc6, 0x5a, 0x0c, 0x98, 0x62, 0x30, 0xb9, 0xb3,
+    0x2a, 0xd1, 0x25, 0x84, 0xe0, 0x34, 0xfe, 0xef,
+    0x75, 0xe9, 0x8b, 0x16, 0x69, 0x1b, 0xc2, 0x71,
+    0xe6, 0xce, 0x57, 0x9e, 0x50, 0xbd, 0xac, 0xcb,
+    0x6d, 0xaf, 0xa6, 0x3e, 0x7f, 0xf7, 0x92, 0x42,
+    0x89, 0xc0, 0x23, 0xfc, 0x0a, 0xb7, 0x4b, 0xd8,
+    0x1f, 0x53, 0x21, 0x49, 0xa4, 0x90, 0x55, 0xaa,
+    0xf6, 0x41, 0xae, 0x3d, 0xbc, 0xca, 0xcd, 0x9d,
+    0x8f, 0xa9, 0x52, 0x48, 0xb6, 0xd7, 0xbf, 0xfb,
+    0x2f, 0xb2, 0x59, 0x97, 0x65, 0x5e, 0xa0, 0x7b,
+    0x1a, 0x70, 0xe8, 0x15, 0x33, 0xee, 0xd0, 0x83,
+    0x3a, 0x45, 0x94, 0x12, 0x0f, 0x10, 0x44, 0x11,
+    0x79, 0x95, 0x81, 0x13, 0x9b, 0x3b, 0xf9, 0x46,
+    0xd6, 0xfa, 0xa8, 0x47, 0xc9, 0x9c, 0x40, 0x3c,
+    0xed, 0x82, 0x6f, 0x14, 0x5d, 0x7a, 0xb1, 0x96,
+};
+
+#endif
+
+#else
+#error "No tables for RAMRSBD_GF_P/RAMRSBD_GF_G, see gf-tables.py"
+#endif
+
+
+#ifndef RAMRSBD_PROFILE_SPEED
 // Multiplication in the field
 uint8_t ramrsbd_gf_mul(uint8_t a, uint8_t b) {
+#if defined(__GFNI__) && RAMRSBD_GF_P == 0x11b
+    // GF2P8MULB multiplies in exactly this field, so we don't need any
+    // tables
+    return _mm_cvtsi128_si32(_mm_gf2p8mul_epi8(
+            _mm_cvtsi32_si128(a),
+            _mm_cvtsi32_si128(b)));
+#else
     // special case for zeros
     if (a == 0 || b == 0) {
         return 0;
@@ -98,6 +789,7 @@ uint8_t ramrsbd_gf_mul(uint8_t a, uint8_t b) {
         x -= 255;
     }
     return RAMRSBD_GF_POW[x];
+#endif
 }
 
 // Division in the field
@@ -118,6 +810,29 @@ uint8_t ramrsbd_gf_div(uint8_t a, uint8_t b) {
     return RAMRSBD_GF_POW[x];
 }
 
+// Discrete log in the field
+uint16_t ramrsbd_gf_log(uint8_t a) {
+    // log_g 0 is undefined, but our table maps it to 0xff, which
+    // ramrsbd_gf_mull treats as zero
+    return RAMRSBD_GF_LOG[a];
+}
+
+// Multiplication by a constant in log form
+uint8_t ramrsbd_gf_mull(uint8_t a, uint16_t l) {
+    // special case for zeros
+    if (a == 0 || l == 0xff) {
+        return 0;
+    }
+
+    // a*g^l = g^(log_g a + l)
+    uint32_t x = (uint32_t)RAMRSBD_GF_LOG[a] + (uint32_t)l;
+    if (x >= 255) {
+        x -= 255;
+    }
+    return RAMRSBD_GF_POW[x];
+}
+#endif
+
 // Exponentiation in the field
 uint8_t ramrsbd_gf_pow(uint8_t a, uint32_t e) {
     // special case for a^0
@@ -132,5 +847,3 @@ uint8_t ramrsbd_gf_pow(uint8_t a, uint32_t e) {
     uint32_t x = ((uint32_t)RAMRSBD_GF_LOG[a] * e) % 255;
     return RAMRSBD_GF_POW[x];
 }
-
-
@@ -9,6 +9,11 @@
 
 #include "lfs_util.h"
 
+#if defined(RAMRSBD_PROFILE_SPEED) \
+        && defined(__GFNI__) && RAMRSBD_GF_P == 0x11b
+#include <immintrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -16,25 +21,96 @@ extern "C"
 
 
 // The irreducible polynomial that defines the field
+//
+// This can be overridden at build time, but ramrsbd_gf.c needs tables
+// for the field, currently 0x11d, 0x11b, and 0x12d are supported. See
+// gf-tables.py to generate tables for other fields.
+//
+// Note that with 0x11b, the AES field, multiplication can use x86's
+// GF2P8MULB instruction if compiled with -mgfni.
+#ifndef RAMRSBD_GF_P
 #define RAMRSBD_GF_P 0x11d
+#endif
 
 // A generator in the field
+//
+// 2 is not a generator of 0x11b, so we default to 3 there.
+#ifndef RAMRSBD_GF_G
+#if RAMRSBD_GF_P == 0x11b
+#define RAMRSBD_GF_G 0x03
+#else
 #define RAMRSBD_GF_G 0x02
+#endif
+#endif
+
+
+// Build profiles
+//
+// By default ramrsbd is built to be small, with 512 bytes of tables and
+// out-of-line math, which is what you want on microcontrollers. Defining
+// RAMRSBD_PROFILE_SPEED trades this for speed: ~1.5 KiB of zero-aware
+// tables that avoid branches, and inlined multiplication/division in
+// the hot loops.
+//
+// The Makefile sets this with PROFILE=speed, see make profile-diff for
+// the cost/benefit.
 
 
 // Note addition/subtraction is just xor, we don't really need a special
 // function for it
 
+#ifndef RAMRSBD_PROFILE_SPEED
 // Multiplication in the field
 uint8_t ramrsbd_gf_mul(uint8_t a, uint8_t b);
 
 // Division in the field
 uint8_t ramrsbd_gf_div(uint8_t a, uint8_t b);
 
+// Discrete log in the field, log_g a
+//
+// This is useful for repeated multiplication by the same constant, see
+// ramrsbd_gf_mull. log_g 0 is undefined, so 0 maps to a sentinel that
+// ramrsbd_gf_mull treats as zero.
+uint16_t ramrsbd_gf_log(uint8_t a);
+
+// Multiplication by a constant in log form, a*g^l
+//
+// l must come from ramrsbd_gf_log, or be an exponent < 255.
+uint8_t ramrsbd_gf_mull(uint8_t a, uint16_t l);
+
+#else
+// pow/log tables, with enough padding in RAMRSBD_GF_POW that we never
+// need to reduce mod 255, and log_g 0 = 510 to land in the zeros
+extern const uint8_t RAMRSBD_GF_POW[1024];
+extern const uint16_t RAMRSBD_GF_LOG[256];
+
+static inline uint8_t ramrsbd_gf_mul(uint8_t a, uint8_t b) {
+#if defined(__GFNI__) && RAMRSBD_GF_P == 0x11b
+    return _mm_cvtsi128_si32(_mm_gf2p8mul_epi8(
+            _mm_cvtsi32_si128(a),
+            _mm_cvtsi32_si128(b)));
+#else
+    return RAMRSBD_GF_POW[RAMRSBD_GF_LOG[a] + RAMRSBD_GF_LOG[b]];
+#endif
+}
+
+static inline uint8_t ramrsbd_gf_div(uint8_t a, uint8_t b) {
+    LFS_ASSERT(b != 0);
+    return RAMRSBD_GF_POW[RAMRSBD_GF_LOG[a] + 255 - RAMRSBD_GF_LOG[b]];
+}
+
+static inline uint16_t ramrsbd_gf_log(uint8_t a) {
+    return RAMRSBD_GF_LOG[a];
+}
+
+static inline uint8_t ramrsbd_gf_mull(uint8_t a, uint16_t l) {
+    return RAMRSBD_GF_POW[RAMRSBD_GF_LOG[a] + l];
+}
+#endif
+
 // Exponentiation in the field
 uint8_t ramrsbd_gf_pow(uint8_t a, uint32_t e);
 
-
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
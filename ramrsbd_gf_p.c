@@ -11,10 +11,18 @@
 uint8_t ramrsbd_gf_p_eval(
         const uint8_t *p, lfs_size_t p_size,
         uint8_t x) {
+    // x is constant so we only need its log once
+    return ramrsbd_gf_p_evall(p, p_size, ramrsbd_gf_log(x));
+}
+
+// Evaluate a polynomial at x, given log_g x
+uint8_t ramrsbd_gf_p_evall(
+        const uint8_t *p, lfs_size_t p_size,
+        uint16_t l) {
     // evaluate using Horner's method
     uint8_t y = 0;
     for (lfs_size_t i = 0; i < p_size; i++) {
-        y = ramrsbd_gf_mul(y, x) ^ p[i];
+        y = ramrsbd_gf_mull(y, l) ^ p[i];
     }
 
     return y;
@@ -24,11 +32,19 @@ uint8_t ramrsbd_gf_p_eval(
 uint8_t ramrsbd_gf_p_deval(
         const uint8_t *p, lfs_size_t p_size,
         uint8_t x) {
-    // evaluate using Horner's method
+    return ramrsbd_gf_p_devall(p, p_size,
+            ramrsbd_gf_log(ramrsbd_gf_mul(x, x)));
+}
+
+// Evaluate the formal derivative of a polynomial at x, given log_g x^2
+uint8_t ramrsbd_gf_p_devall(
+        const uint8_t *p, lfs_size_t p_size,
+        uint16_t l2) {
+    // evaluate using Horner's method, in GF(2^n) only the odd terms
+    // survive differentiation, so this is a polynomial in x^2
     uint8_t y = 0;
-    uint8_t x2 = ramrsbd_gf_mul(x, x);
     for (lfs_size_t i = p_size % 2; i < p_size; i += 2) {
-        y = ramrsbd_gf_mul(y, x2) ^ p[i];
+        y = ramrsbd_gf_mull(y, l2) ^ p[i];
     }
 
     return y;
@@ -38,8 +54,9 @@ uint8_t ramrsbd_gf_p_deval(
 void ramrsbd_gf_p_scale(
         uint8_t *p, lfs_size_t p_size,
         uint8_t c) {
+    uint16_t c_ = ramrsbd_gf_log(c);
     for (lfs_size_t i = 0; i < p_size; i++) {
-        p[i] = ramrsbd_gf_mul(p[i], c);
+        p[i] = ramrsbd_gf_mull(p[i], c_);
     }
 }
 
@@ -64,8 +81,9 @@ void ramrsbd_gf_p_xors(
     LFS_ASSERT(a_size >= b_size);
 
     // this just gets a little bit confusing since b may be smaller than a
+    uint16_t c_ = ramrsbd_gf_log(c);
     for (lfs_size_t i = 0; i < b_size; i++) {
-        a[(a_size-b_size)+i] ^= ramrsbd_gf_mul(b[i], c);
+        a[(a_size-b_size)+i] ^= ramrsbd_gf_mull(b[i], c_);
     }
 }
 
@@ -81,13 +99,13 @@ void ramrsbd_gf_p_mul(
     // always <= i
     //
     for (lfs_size_t i = 0; i < a_size; i++) {
-        uint8_t x = a[i];
+        uint16_t x = ramrsbd_gf_log(a[i]);
         a[i] = 0;
 
         for (lfs_size_t j = ((i < b_size) ? b_size-1-i : 0);
                 j < b_size;
                 j++) {
-            a[i-(b_size-1)+j] ^= ramrsbd_gf_mul(x, b[j]);
+            a[i-(b_size-1)+j] ^= ramrsbd_gf_mull(b[j], x);
         }
     }
 }
@@ -107,8 +125,9 @@ void ramrsbd_gf_p_divmod(
             // normalize
             a[i] = ramrsbd_gf_div(a[i], c);
 
+            uint16_t x = ramrsbd_gf_log(a[i]);
             for (lfs_size_t j = 1; j < b_size; j++) {
-                a[i+j] ^= ramrsbd_gf_mul(a[i], b[j]);
+                a[i+j] ^= ramrsbd_gf_mull(b[j], x);
             }
         }
     }
@@ -127,8 +146,9 @@ void ramrsbd_gf_p_divmod1(
     // divide via synthetic division
     for (lfs_size_t i = 0; i < a_size-b_size; i++) {
         if (a[i] != 0) {
+            uint16_t x = ramrsbd_gf_log(a[i]);
             for (lfs_size_t j = 0; j < b_size; j++) {
-                a[i+j+1] ^= ramrsbd_gf_mul(a[i], b[j]);
+                a[i+j+1] ^= ramrsbd_gf_mull(b[j], x);
             }
         }
     }
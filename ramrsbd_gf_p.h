@@ -22,11 +22,24 @@ uint8_t ramrsbd_gf_p_eval(
         const uint8_t *p, lfs_size_t p_size,
         uint8_t x);
 
+// Evaluate a polynomial at x, given log_g x
+//
+// This is useful when x comes from a precomputed table, see
+// ramrsbd_rs_plan.
+uint8_t ramrsbd_gf_p_evall(
+        const uint8_t *p, lfs_size_t p_size,
+        uint16_t l);
+
 // Evaluate the formal derivative of a polynomial at x
 uint8_t ramrsbd_gf_p_deval(
         const uint8_t *p, lfs_size_t p_size,
         uint8_t x);
 
+// Evaluate the formal derivative of a polynomial at x, given log_g x^2
+uint8_t ramrsbd_gf_p_devall(
+        const uint8_t *p, lfs_size_t p_size,
+        uint16_t l2);
+
 // Multiply a polynomial by a constant c
 void ramrsbd_gf_p_scale(
         uint8_t *p, lfs_size_t p_size,
@@ -0,0 +1,243 @@
+/*
+ * Replay recorded ramrsbd traces for benchmarking
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clock_gettime is POSIX, not C99
+#define _POSIX_C_SOURCE 199309L
+
+#include "ramrsbd_replay.h"
+
+#include <time.h>
+
+
+// read a little-endian 32-bit word from a trace
+static bool ramrsbd_replay_le32(FILE *f, uint32_t *x) {
+    uint8_t b[4];
+    if (fread(b, 1, 4, f) != 4) {
+        return false;
+    }
+
+    *x = ((uint32_t)b[0] << 0)
+            | ((uint32_t)b[1] << 8)
+            | ((uint32_t)b[2] << 16)
+            | ((uint32_t)b[3] << 24);
+    return true;
+}
+
+// current time in nanoseconds, only useful for differences
+static uint64_t ramrsbd_replay_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec*1000000000 + (uint64_t)t.tv_nsec;
+}
+
+// add a request to our stats
+static void ramrsbd_replay_sample(ramrsbd_replay_stats_t *stats,
+        uint8_t op, int err, lfs_size_t bytes, uint64_t ns) {
+    struct ramrsbd_replay_op *op_ = &stats->ops[op-1];
+    if (op_->count == 0 || ns < op_->min_ns) {
+        op_->min_ns = ns;
+    }
+    if (ns > op_->max_ns) {
+        op_->max_ns = ns;
+    }
+
+    op_->count += 1;
+    op_->errors += (err) ? 1 : 0;
+    op_->bytes += bytes;
+    op_->ns += ns;
+    stats->ns += ns;
+
+    // find our log2 bucket
+    uint32_t i = 0;
+    while (i < RAMRSBD_REPLAY_BUCKETS-1 && (ns >> (i+1)) != 0) {
+        i += 1;
+    }
+    op_->hist[i] += 1;
+}
+
+int ramrsbd_replay(const struct lfs_config *cfg, const char *path,
+        ramrsbd_replay_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return LFS_ERR_IO;
+    }
+
+    // check our magic and the recorded geometry
+    int err = 0;
+    uint8_t *buffer = NULL;
+    uint8_t magic[8];
+    uint32_t read_size;
+    uint32_t prog_size;
+    uint32_t block_size;
+    uint32_t block_count;
+    if (fread(magic, 1, 8, f) != 8
+            || memcmp(magic, RAMRSBD_RECORD_MAGIC, 8) != 0
+            || !ramrsbd_replay_le32(f, &read_size)
+            || !ramrsbd_replay_le32(f, &prog_size)
+            || !ramrsbd_replay_le32(f, &block_size)
+            || !ramrsbd_replay_le32(f, &block_count)) {
+        err = LFS_ERR_CORRUPT;
+        goto cleanup;
+    }
+
+    // the recorded device only needs to fit, read/prog sizes may differ
+    (void)read_size;
+    (void)prog_size;
+    if (block_size > cfg->block_size || block_count > cfg->block_count) {
+        err = LFS_ERR_INVAL;
+        goto cleanup;
+    }
+
+    // one block for reads, and one block of pseudo-random data for progs
+    buffer = lfs_malloc(2*cfg->block_size);
+    if (!buffer) {
+        err = LFS_ERR_NOMEM;
+        goto cleanup;
+    }
+
+    uint32_t prng = 42;
+    for (lfs_size_t i = 0; i < cfg->block_size; i++) {
+        prng ^= prng << 13;
+        prng ^= prng >> 17;
+        prng ^= prng << 5;
+        buffer[cfg->block_size + i] = prng;
+    }
+
+    while (true) {
+        int op = fgetc(f);
+        if (op == EOF) {
+            break;
+        }
+
+        // parse the request
+        uint32_t block = 0;
+        uint32_t off = 0;
+        uint32_t size = 0;
+        if (op == RAMRSBD_OP_READ || op == RAMRSBD_OP_PROG) {
+            if (!ramrsbd_replay_le32(f, &block)
+                    || !ramrsbd_replay_le32(f, &off)
+                    || !ramrsbd_replay_le32(f, &size)) {
+                err = LFS_ERR_CORRUPT;
+                goto cleanup;
+            }
+        } else if (op == RAMRSBD_OP_ERASE) {
+            if (!ramrsbd_replay_le32(f, &block)) {
+                err = LFS_ERR_CORRUPT;
+                goto cleanup;
+            }
+        } else if (op != RAMRSBD_OP_SYNC) {
+            err = LFS_ERR_CORRUPT;
+            goto cleanup;
+        }
+
+        if (block >= block_count || off > block_size
+                || size > block_size - off) {
+            err = LFS_ERR_CORRUPT;
+            goto cleanup;
+        }
+
+        // widen to our read/prog size if needed
+        if (op == RAMRSBD_OP_READ || op == RAMRSBD_OP_PROG) {
+            lfs_size_t align = (op == RAMRSBD_OP_READ)
+                    ? cfg->read_size
+                    : cfg->prog_size;
+            lfs_off_t off_ = lfs_aligndown(off, align);
+            size = lfs_alignup(off+size, align) - off_;
+            off = off_;
+            if (off+size > cfg->block_size) {
+                err = LFS_ERR_INVAL;
+                goto cleanup;
+            }
+        }
+
+        // replay, timing only the request itself
+        uint64_t start = ramrsbd_replay_now();
+        int err_;
+        lfs_size_t bytes = size;
+        if (op == RAMRSBD_OP_READ) {
+            err_ = cfg->read(cfg, block, off, buffer, size);
+        } else if (op == RAMRSBD_OP_PROG) {
+            err_ = cfg->prog(cfg, block, off,
+                    &buffer[cfg->block_size], size);
+        } else if (op == RAMRSBD_OP_ERASE) {
+            err_ = cfg->erase(cfg, block);
+            bytes = cfg->block_size;
+        } else {
+            err_ = cfg->sync(cfg);
+        }
+        uint64_t ns = ramrsbd_replay_now() - start;
+
+        ramrsbd_replay_sample(stats, op, err_, bytes, ns);
+    }
+
+    if (ferror(f)) {
+        err = LFS_ERR_IO;
+    }
+
+cleanup:
+    lfs_free(buffer);
+    fclose(f);
+    return err;
+}
+
+uint64_t ramrsbd_replay_percentile(const struct ramrsbd_replay_op *op,
+        uint32_t permille) {
+    if (op->count == 0) {
+        return 0;
+    }
+
+    // find the bucket containing our percentile, rounding up
+    uint64_t target = (op->count*permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < RAMRSBD_REPLAY_BUCKETS; i++) {
+        seen += op->hist[i];
+        if (seen >= target) {
+            // note the max is a tighter bound for the last bucket
+            uint64_t bound = ((uint64_t)2 << i) - 1;
+            return (bound < op->max_ns) ? bound : op->max_ns;
+        }
+    }
+
+    return op->max_ns;
+}
+
+void ramrsbd_replay_report(const ramrsbd_replay_stats_t *stats, FILE *f) {
+    static const char *const names[4] = {"read", "prog", "erase", "sync"};
+
+    fprintf(f, "%-6s %10s %8s %14s %10s "
+                "%10s %10s %10s %10s %10s\n",
+            "op", "count", "errors", "bytes", "MiB/s",
+            "min ns", "p50 ns", "p90 ns", "p99 ns", "max ns");
+
+    uint64_t count = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    for (int i = 0; i < 4; i++) {
+        const struct ramrsbd_replay_op *op = &stats->ops[i];
+        count += op->count;
+        errors += op->errors;
+        bytes += (i+1 != RAMRSBD_OP_ERASE) ? op->bytes : 0;
+
+        fprintf(f, "%-6s %10"PRIu64" %8"PRIu64" %14"PRIu64" %10.2f "
+                    "%10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64" "
+                    "%10"PRIu64"\n",
+                names[i], op->count, op->errors, op->bytes,
+                (op->ns) ? (op->bytes/1048576.0) / (op->ns/1.0e9) : 0.0,
+                op->min_ns,
+                ramrsbd_replay_percentile(op, 500),
+                ramrsbd_replay_percentile(op, 900),
+                ramrsbd_replay_percentile(op, 990),
+                op->max_ns);
+    }
+
+    // total throughput only counts bytes read/progged, erases don't
+    // really move any data
+    fprintf(f, "%-6s %10"PRIu64" %8"PRIu64" %14"PRIu64" %10.2f\n",
+            "total", count, errors, bytes,
+            (stats->ns) ? (bytes/1048576.0) / (stats->ns/1.0e9) : 0.0);
+}
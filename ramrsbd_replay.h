@@ -0,0 +1,87 @@
+/*
+ * Replay recorded ramrsbd traces for benchmarking
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef RAMRSBD_REPLAY_H
+#define RAMRSBD_REPLAY_H
+
+#include "lfs.h"
+#include "lfs_util.h"
+#include "ramrsbd.h"
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Number of latency histogram buckets, bucket i counts requests that
+// took [2^i, 2^(i+1)) nanoseconds
+#define RAMRSBD_REPLAY_BUCKETS 40
+
+// Replay stats for one kind of request
+struct ramrsbd_replay_op {
+    // Number of requests.
+    uint64_t count;
+
+    // Number of requests that returned an error.
+    //
+    // Errors, such as LFS_ERR_CORRUPT from fault injection, don't stop
+    // the replay.
+    uint64_t errors;
+
+    // Number of bytes read/progged/erased.
+    uint64_t bytes;
+
+    // Total, min, and max latency in nanoseconds.
+    uint64_t ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+
+    // Latency histogram, see RAMRSBD_REPLAY_BUCKETS.
+    uint64_t hist[RAMRSBD_REPLAY_BUCKETS];
+};
+
+// Replay stats, see ramrsbd_replay
+typedef struct ramrsbd_replay_stats {
+    // Total time spent in requests in nanoseconds.
+    uint64_t ns;
+
+    // Stats for each kind of request, indexed by enum ramrsbd_op - 1.
+    struct ramrsbd_replay_op ops[4];
+} ramrsbd_replay_stats_t;
+
+
+// Replay a binary trace, see ramrsbd_config.record_path
+//
+// Requests are replayed back-to-back through cfg's read/prog/erase/sync,
+// so any ramrsbd configuration can be benchmarked against the same
+// trace. Progs write deterministic pseudo-random data. Requests not
+// aligned to cfg's read/prog size are widened to fit.
+//
+// Returns LFS_ERR_CORRUPT if the trace is malformed, or LFS_ERR_INVAL
+// if the trace doesn't fit in the block device.
+int ramrsbd_replay(const struct lfs_config *cfg, const char *path,
+        ramrsbd_replay_stats_t *stats);
+
+// Find an approximate latency percentile in nanoseconds
+//
+// The percentile is in permille, so 500 is the median and 990 is p99.
+// This is limited by the resolution of the histogram, and returns the
+// upper bound of the bucket containing the percentile.
+uint64_t ramrsbd_replay_percentile(const struct ramrsbd_replay_op *op,
+        uint32_t permille);
+
+// Print a human-readable report of throughput and latencies
+void ramrsbd_replay_report(const ramrsbd_replay_stats_t *stats, FILE *f);
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
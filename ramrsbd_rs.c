@@ -0,0 +1,594 @@
+/*
+ * Reed-Solomon encoding/decoding utilities
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "ramrsbd_rs.h"
+
+
+// Start encoding a message
+void ramrsbd_rs_enc_init(ramrsbd_rs_enc_t *enc,
+        const uint8_t *p, uint8_t *e, lfs_size_t ecc_size) {
+    enc->p = p;
+    enc->e = e;
+    enc->ecc_size = ecc_size;
+    enc->size = 0;
+
+    // let E(x) = 0
+    memset(enc->e, 0, enc->ecc_size);
+}
+
+// Feed the next part of a message into the encoder
+void ramrsbd_rs_enc_update(ramrsbd_rs_enc_t *enc,
+        const void *buffer, lfs_size_t size) {
+    // there's only 255 non-zero elements in GF(256), so codewords are
+    // limited to at most 255 bytes
+    LFS_ASSERT(enc->size + size + enc->ecc_size <= 255);
+    enc->size += size;
+
+    // this is the same synthetic division as ramrsbd_gf_p_divmod1, but
+    // with only the next n terms of the remainder in memory, like an LFSR
+    //
+    // let E(x) = (E(x) x + m_i x^n) mod P(x)
+    //
+    const uint8_t *buffer_ = buffer;
+    for (lfs_size_t i = 0; i < size; i++) {
+        // the leading term of E(x) x + m_i x^n is what we need to cancel
+        // with P(x), so shift and subtract f P(x) in one pass
+        uint16_t f = ramrsbd_gf_log(buffer_[i] ^ enc->e[0]);
+        for (lfs_size_t j = 0; j < enc->ecc_size-1; j++) {
+            enc->e[j] = enc->e[j+1] ^ ramrsbd_gf_mull(enc->p[j], f);
+        }
+        enc->e[enc->ecc_size-1] = ramrsbd_gf_mull(
+                enc->p[enc->ecc_size-1], f);
+    }
+}
+
+// Finish encoding a message, writing ecc_size bytes of ecc
+void ramrsbd_rs_enc_final(ramrsbd_rs_enc_t *enc, void *ecc) {
+    // E(x) is now M(x) x^n mod P(x), which is our ecc
+    if (ecc != enc->e) {
+        memcpy(ecc, enc->e, enc->ecc_size);
+    }
+}
+
+// Start finding the syndromes of a codeword
+void ramrsbd_rs_syn_init(ramrsbd_rs_syn_t *syn,
+        uint8_t *s, lfs_size_t ecc_size) {
+    syn->s = s;
+    syn->ecc_size = ecc_size;
+    syn->size = 0;
+
+    // let S_i = 0
+    memset(syn->s, 0, syn->ecc_size);
+}
+
+// Feed the next part of a codeword, message then ecc, into the syndromes
+void ramrsbd_rs_syn_update(ramrsbd_rs_syn_t *syn,
+        const void *buffer, lfs_size_t size) {
+    LFS_ASSERT(syn->size + size <= 255);
+    syn->size += size;
+
+    // continue evaluating S_i = C(g^i) using Horner's method, like
+    // ramrsbd_gf_p_eval, Horner's method conveniently only needs the
+    // result so far
+    //
+    // note x = g^i, so we already know its log
+    //
+    const uint8_t *buffer_ = buffer;
+    lfs_size_t i = 0;
+#ifdef RAMRSBD_PROFILE_SPEED
+    // each S_i is one long chain of dependent table lookups, so evaluate
+    // 4 at a time to keep more lookups in flight
+    for (; i+4 <= syn->ecc_size; i += 4) {
+        uint16_t x0 = syn->ecc_size-1-(i+0);
+        uint16_t x1 = syn->ecc_size-1-(i+1);
+        uint16_t x2 = syn->ecc_size-1-(i+2);
+        uint16_t x3 = syn->ecc_size-1-(i+3);
+        uint8_t y0 = syn->s[i+0];
+        uint8_t y1 = syn->s[i+1];
+        uint8_t y2 = syn->s[i+2];
+        uint8_t y3 = syn->s[i+3];
+        for (lfs_size_t j = 0; j < size; j++) {
+            y0 = ramrsbd_gf_mull(y0, x0) ^ buffer_[j];
+            y1 = ramrsbd_gf_mull(y1, x1) ^ buffer_[j];
+            y2 = ramrsbd_gf_mull(y2, x2) ^ buffer_[j];
+            y3 = ramrsbd_gf_mull(y3, x3) ^ buffer_[j];
+        }
+        syn->s[i+0] = y0;
+        syn->s[i+1] = y1;
+        syn->s[i+2] = y2;
+        syn->s[i+3] = y3;
+    }
+#endif
+    for (; i < syn->ecc_size; i++) {
+        uint16_t x = syn->ecc_size-1-i;
+        uint8_t y = syn->s[i];
+        for (lfs_size_t j = 0; j < size; j++) {
+            y = ramrsbd_gf_mull(y, x) ^ buffer_[j];
+        }
+        syn->s[i] = y;
+    }
+}
+
+// Finish finding the syndromes of a codeword
+bool ramrsbd_rs_syn_final(ramrsbd_rs_syn_t *syn) {
+    // keep track of if we have any non-zero syndromes
+    for (lfs_size_t i = 0; i < syn->ecc_size; i++) {
+        if (syn->s[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Find the generator polynomial P(x) for ecc_size bytes of ecc
+void ramrsbd_rs_p(uint8_t *p, lfs_size_t ecc_size) {
+    // calculate generator polynomial
+    //
+    // P(x) = prod_i^n-1 (x - g^i)
+    //
+    // the important property of P(x) is that it evaluates to 0
+    // at every x=g^i for i < n
+    //
+    // normally P(x) needs n+1 terms, but the leading term is
+    // always 1, so we can make it implicit
+    //
+
+    // let P(x) = 1
+    memset(p, 0, ecc_size);
+    p[ecc_size-1] = 1;
+
+    for (lfs_size_t i = 0; i < ecc_size; i++) {
+        // let R(x) = x - g^i
+        uint8_t r[2] = {1, ramrsbd_gf_pow(RAMRSBD_GF_G, i)};
+
+        // let P(x) = P(x) * R(x)
+        ramrsbd_gf_p_mul(
+                p, ecc_size,
+                r, 2);
+    }
+}
+
+// Build a decode plan for codewords with up to size positions
+void ramrsbd_rs_plan(ramrsbd_rs_plan_t *plan,
+        void *buffer, lfs_size_t size) {
+    LFS_ASSERT(size <= 255);
+    uint8_t *x = buffer;
+    uint8_t *l = &x[size];
+    uint8_t *l2 = &l[size];
+
+    // step through powers of g, rather than finding each one
+    uint8_t x_k = 1;
+    for (lfs_size_t k = 0; k < size; k++) {
+        // let X_k = g^k
+        x[k] = x_k;
+        // log_g X_k^-1 = -k mod 255
+        l[k] = (255 - k) % 255;
+        // log_g X_k^-2 = -2k mod 255
+        l2[k] = (2*(255 - k)) % 255;
+
+        x_k = ramrsbd_gf_mul(x_k, RAMRSBD_GF_G);
+    }
+
+    plan->size = size;
+    plan->x = x;
+    plan->l = l;
+    plan->l2 = l2;
+}
+
+// find the set of syndromes S for a codeword C(x)
+//
+// S_i = C(g^i)
+//
+// if our codeword contains no errors, these should all be zero,
+// otherwise they tell us information about the errors,
+// S_i = sum_j Y_j X_j^i where j is an error
+//
+// also returns true if zero for convenience
+static bool ramrsbd_rs_find_s(
+        uint8_t *s, lfs_size_t s_size,
+        const uint8_t *c, lfs_size_t c_size) {
+    // calculate syndromes, this is just the streaming syndromes with
+    // only one chunk
+    ramrsbd_rs_syn_t syn;
+    ramrsbd_rs_syn_init(&syn, s, s_size);
+    ramrsbd_rs_syn_update(&syn, c, c_size);
+    return ramrsbd_rs_syn_final(&syn);
+}
+
+// Find the error-locator polynomial Λ(x) with Berlekamp-Massey
+//
+// Λ(x) = prod_j (1 - X_j x) = 1 + sum_k=1^e Λ_k x^k
+//
+// where Λ(X_j^-1)=0 if j is an error and Λ(0)=1
+lfs_size_t ramrsbd_rs_find_λ(
+        uint8_t *λ, lfs_size_t λ_size,
+        uint8_t *c, lfs_size_t c_size,
+        const uint8_t *s, lfs_size_t s_size) {
+    LFS_ASSERT(c_size == λ_size);
+    LFS_ASSERT(s_size == λ_size);
+
+    // iteratively find the error-locator using Berlekamp-Massey
+    //
+    // this treats Λ as an LFSR we need to solve in GF(256)
+    //
+
+    // guess an error-locator LFSR
+    //
+    // let e = 0    // guessed LFSR size/number of errors
+    // let Λ(i) = 1 // current LFSR guess
+    // let C(i) = 1 // best LFSR so far
+    //
+    lfs_size_t e = 0;
+    memset(λ, 0, λ_size-1);
+    λ[λ_size-1] = 1;
+    memset(c, 0, c_size-1);
+    c[c_size-1] = 1;
+
+    // iterate through symbols
+    for (lfs_size_t n = 0; n < s_size; n++) {
+        // shift C(i) = C(i-1)
+        memmove(c, c+1, c_size-1);
+        c[c_size-1] = 0;
+
+        // calculate next symbol discrepancy
+        //
+        // let d = S_n - Λ(n) = S_n - sum_k=1^e Λ_k S_n-k
+        //
+        uint8_t d = s[s_size-1-n];
+        for (lfs_size_t k = 1; k <= e; k++) {
+            d ^= ramrsbd_gf_mul(
+                    λ[λ_size-1-k],
+                    s[s_size-1-(n-k)]);
+        }
+
+        // found discrepancy?
+        if (d != 0) {
+            // let Λ(i) = Λ(i) - d C(i)
+            ramrsbd_gf_p_xors(
+                    λ, λ_size,
+                    d,
+                    c, c_size);
+
+            // not enough errors for discrepancy?
+            if (n >= 2*e) {
+                // update the number of errors
+                e = n+1 - e;
+
+                // save best LFSR for later
+                //
+                // this should be C(i) = d^-1 Λ(i), but before we
+                // modified Λ(i) = Λ(i) - d C(i), fortunately we can just
+                // undo the modification to avoid needing another buffer:
+                //
+                // let C(i) = d^-1 (Λ(i) + d C(i))
+                //          = C(i) + d^-1 Λ(i)
+                //
+                ramrsbd_gf_p_xors(
+                        c, c_size,
+                        ramrsbd_gf_div(1, d),
+                        λ, λ_size);
+            }
+        }
+    }
+
+    return e;
+}
+
+// find the error-evaluator polynomial Ω(x), given a syndrome
+// polynomial S(x) and an error-locator polynomial Λ(x)
+//
+// Ω(x) = S(x) Λ(x) mod x^n
+//
+// this indirectly gives us our error-magnitudes Y_j for a given X_j,
+// Ω(X_j^-1) = Y_j X_j Λ'(X_j^-1), if j is an error
+//
+static void ramrsbd_rs_find_ω(
+        uint8_t *ω, lfs_size_t ω_size,
+        const uint8_t *s, lfs_size_t s_size,
+        const uint8_t *λ, lfs_size_t λ_size) {
+    LFS_ASSERT(ω_size == s_size);
+    LFS_ASSERT(ω_size == λ_size);
+
+    // let Ω(x) = S(x) Λ(x) mod x^n
+    //
+    // note that the mod is really just truncating the array, which
+    // ramrsbd_gf_p_mul does implicitly if the array is too small
+    //
+    memcpy(ω, s, s_size);
+    ramrsbd_gf_p_mul(
+            ω, ω_size,
+            λ, λ_size);
+}
+
+// find and repair errors in a codeword C(x), given the error-locator Λ(x)
+// and error-evaluator Ω(x)
+//
+// note this only depends on Λ(x) and Ω(x), so repairing twice undoes
+// the repair
+static void ramrsbd_rs_repair(const ramrsbd_rs_t *rs, uint8_t *c) {
+    // brute force search for error locations, this is any
+    // location X_j=g^j where X_j^-1 is a root of our
+    // error-locator, Λ(X_j^-1) = 0
+    LFS_ASSERT(!rs->plan || rs->code_size <= rs->plan->size);
+    for (lfs_size_t j = 0; j < rs->code_size; j++) {
+        // map the error location to the multiplicative ring
+        //
+        // let X_j = g^j
+        //
+        // we also need X_j^-1 and X_j^-2 in log form to evaluate our
+        // polynomials, these are all precomputed if we have a plan
+        //
+        lfs_size_t k = rs->code_size-1-j;
+        uint8_t x_j;
+        uint16_t l;
+        uint16_t l2;
+        if (rs->plan) {
+            x_j = rs->plan->x[k];
+            l = rs->plan->l[k];
+            l2 = rs->plan->l2[k];
+        } else {
+            x_j = ramrsbd_gf_pow(RAMRSBD_GF_G, k);
+            uint8_t x_j_ = ramrsbd_gf_div(1, x_j);
+            l = ramrsbd_gf_log(x_j_);
+            l2 = ramrsbd_gf_log(ramrsbd_gf_mul(x_j_, x_j_));
+        }
+
+        // is X_j a root of our error-locator?
+        //
+        // does Λ(X_j^-1) = 0?
+        //
+        if (ramrsbd_gf_p_evall(
+                    rs->λ, rs->ecc_size,
+                    l)
+                != 0) {
+            continue;
+        }
+
+        // found an error location, now find its magnitude
+        //
+        //                Ω(X_j^-1)
+        // let Y_j = X_j ----------
+        //               Λ'(X_j^-1)
+        //
+        uint8_t y_j = ramrsbd_gf_mul(
+                x_j,
+                ramrsbd_gf_div(
+                    ramrsbd_gf_p_evall(
+                        rs->ω, rs->ecc_size,
+                        l),
+                    ramrsbd_gf_p_devall(
+                        rs->λ, rs->ecc_size,
+                        l2)));
+
+        // found error location and magnitude, now we can fix it!
+        c[j] ^= y_j;
+    }
+}
+
+// decode a codeword C(x) in place, returning the number of errors
+// corrected, or -1 if uncorrectable
+static lfs_ssize_t ramrsbd_rs_decode1(const ramrsbd_rs_t *rs, uint8_t *c) {
+    // calculate syndromes
+    bool s_zero = ramrsbd_rs_find_s(
+            rs->s, rs->ecc_size,
+            c, rs->code_size);
+
+    // zero syndromes? no errors
+    if (s_zero) {
+        return 0;
+    }
+
+    // find the error-locator polynomial Λ(x)
+    lfs_size_t n = ramrsbd_rs_find_λ(
+            rs->λ, rs->ecc_size,
+            // use Ω(x) as scratch space
+            rs->ω, rs->ecc_size,
+            rs->s, rs->ecc_size);
+
+    // too many errors?
+    if (n > rs->ecc_size/2
+            || (rs->error_correction
+                && (lfs_ssize_t)n > rs->error_correction)) {
+        return -1;
+    }
+
+    // find the error evaluator polynomial Ω(x)
+    ramrsbd_rs_find_ω(
+            rs->ω, rs->ecc_size,
+            rs->s, rs->ecc_size,
+            rs->λ, rs->ecc_size);
+
+    // find and fix our errors
+    ramrsbd_rs_repair(rs, c);
+
+    // calculate syndromes again to make sure we found all errors
+    s_zero = ramrsbd_rs_find_s(
+            rs->s, rs->ecc_size,
+            c, rs->code_size);
+    if (!s_zero) {
+        // undo our repair, so we don't make things worse
+        ramrsbd_rs_repair(rs, c);
+        return -1;
+    }
+
+    return n;
+}
+
+// Encode an array of codewords in place
+void ramrsbd_rs_encode(const ramrsbd_rs_t *rs,
+        void *buffer, lfs_size_t count) {
+    uint8_t *buffer_ = buffer;
+    for (lfs_size_t i = 0; i < count; i++) {
+        // let C(x) = M(x) x^n + (M(x) x^n mod P(x))
+        //
+        // we can use the codeword's own ecc as the encoder's remainder
+        //
+        uint8_t *c = &buffer_[i*rs->code_size];
+        uint8_t *e = &c[rs->code_size-rs->ecc_size];
+        ramrsbd_rs_enc_t enc;
+        ramrsbd_rs_enc_init(&enc, rs->p, e, rs->ecc_size);
+        ramrsbd_rs_enc_update(&enc, c, rs->code_size-rs->ecc_size);
+        ramrsbd_rs_enc_final(&enc, e);
+    }
+}
+
+// number of 64-bit words in each of the bitsliced encoder's bit planes
+#define RAMRSBD_RS_WORDS (RAMRSBD_RS_LANES/64)
+
+// transpose an 8x8 bit matrix, so bit j of byte i becomes bit i of
+// byte j
+static uint64_t ramrsbd_rs_transpose8(uint64_t x) {
+    // swap 1x1, 2x2, then 4x4 blocks
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aa;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000cccc;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+// Encode many codewords at once with a bitsliced encoder
+void ramrsbd_rs_encode_bitsliced(
+        const uint8_t *p, lfs_size_t ecc_size,
+        const void *m, lfs_size_t m_size, lfs_size_t m_stride,
+        void *e, lfs_size_t e_stride,
+        lfs_size_t count,
+        uint64_t *planes) {
+    LFS_ASSERT(ecc_size > 0);
+    LFS_ASSERT(m_size + ecc_size <= 255);
+    const uint8_t *m_ = m;
+    uint8_t *e_ = e;
+
+    // this is the same LFSR as ramrsbd_rs_enc_update, but each GF(256)
+    // element is stored as 8 bit planes, with bit r of codeword l in
+    // bit l of plane r
+    //
+    // multiplication by a constant c is linear over GF(2), so if we know
+    // F x^k for each k:
+    //
+    // c F = sum_k c_k (F x^k)
+    //
+    // and F x is just a shift of the planes, with a fixed xor of the
+    // overflow determined by RAMRSBD_GF_P
+    //
+    // E holds our running remainder, indexed as a ring so shifting E(x)
+    // is free, and T holds F x^k
+    //
+    uint64_t (*E)[8][RAMRSBD_RS_WORDS]
+            = (uint64_t (*)[8][RAMRSBD_RS_WORDS])planes;
+    uint64_t (*T)[8][RAMRSBD_RS_WORDS]
+            = &E[ecc_size];
+
+    for (lfs_size_t k = 0; k < count; k += RAMRSBD_RS_LANES) {
+        lfs_size_t lanes = lfs_min(count-k, RAMRSBD_RS_LANES);
+
+        // let E(x) = 0
+        memset(E, 0, ecc_size*sizeof(E[0]));
+        lfs_size_t head = 0;
+
+        for (lfs_size_t i = 0; i < m_size; i++) {
+            // transpose the next byte of each message into T[0], 8
+            // codewords at a time
+            memset(T[0], 0, sizeof(T[0]));
+            for (lfs_size_t l = 0; l < lanes; l += 8) {
+                uint64_t x = 0;
+                for (lfs_size_t q = 0; q < 8 && l+q < lanes; q++) {
+                    x |= (uint64_t)m_[(k+l+q)*m_stride + i] << (8*q);
+                }
+
+                x = ramrsbd_rs_transpose8(x);
+                for (lfs_size_t r = 0; r < 8; r++) {
+                    T[0][r][l/64] |= ((x >> (8*r)) & 0xff) << (l%64);
+                }
+            }
+
+            // let F = m_i + E_0
+            for (lfs_size_t r = 0; r < 8; r++) {
+                for (lfs_size_t w = 0; w < RAMRSBD_RS_WORDS; w++) {
+                    T[0][r][w] ^= E[head][r][w];
+                }
+            }
+
+            // find F x^b for b < 8
+            for (lfs_size_t b = 1; b < 8; b++) {
+                for (lfs_size_t w = 0; w < RAMRSBD_RS_WORDS; w++) {
+                    uint64_t carry = T[b-1][7][w];
+                    T[b][0][w] = carry;
+                    for (lfs_size_t r = 1; r < 8; r++) {
+                        T[b][r][w] = T[b-1][r-1][w]
+                                ^ (carry & -(uint64_t)(
+                                    (RAMRSBD_GF_P >> r) & 1));
+                    }
+                }
+            }
+
+            // let E(x) = E(x) x + F P(x)
+            //
+            // E_j moves to slot head+j+1 when we shift, which is where
+            // E_j+1 already is, and the new E_n-1 takes E_0's old slot
+            //
+            for (lfs_size_t j = 0; j < ecc_size; j++) {
+                uint64_t mask[8];
+                for (lfs_size_t b = 0; b < 8; b++) {
+                    mask[b] = -(uint64_t)((p[j] >> b) & 1);
+                }
+
+                uint64_t (*e__)[RAMRSBD_RS_WORDS]
+                        = E[(head + j + 1) % ecc_size];
+                for (lfs_size_t r = 0; r < 8; r++) {
+                    for (lfs_size_t w = 0; w < RAMRSBD_RS_WORDS; w++) {
+                        uint64_t y = (j < ecc_size-1) ? e__[r][w] : 0;
+                        for (lfs_size_t b = 0; b < 8; b++) {
+                            y ^= T[b][r][w] & mask[b];
+                        }
+                        e__[r][w] = y;
+                    }
+                }
+            }
+            head = (head + 1) % ecc_size;
+        }
+
+        // transpose our remainder back out, which is our ecc
+        for (lfs_size_t j = 0; j < ecc_size; j++) {
+            uint64_t (*e__)[RAMRSBD_RS_WORDS] = E[(head + j) % ecc_size];
+            for (lfs_size_t l = 0; l < lanes; l += 8) {
+                uint64_t x = 0;
+                for (lfs_size_t r = 0; r < 8; r++) {
+                    x |= ((e__[r][l/64] >> (l%64)) & 0xff) << (8*r);
+                }
+
+                x = ramrsbd_rs_transpose8(x);
+                for (lfs_size_t q = 0; q < 8 && l+q < lanes; q++) {
+                    e_[(k+l+q)*e_stride + j] = x >> (8*q);
+                }
+            }
+        }
+    }
+}
+
+// Decode an array of codewords in place
+int ramrsbd_rs_decode(const ramrsbd_rs_t *rs,
+        void *buffer, lfs_size_t count, int8_t *results) {
+    uint8_t *buffer_ = buffer;
+    int err = 0;
+    for (lfs_size_t i = 0; i < count; i++) {
+        lfs_ssize_t n = ramrsbd_rs_decode1(rs,
+                &buffer_[i*rs->code_size]);
+        if (n < 0) {
+            err = LFS_ERR_CORRUPT;
+        }
+
+        if (results) {
+            results[i] = n;
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,215 @@
+/*
+ * Reed-Solomon encoding/decoding utilities
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef RAMRSBD_RS_H
+#define RAMRSBD_RS_H
+
+#include "lfs.h"
+#include "lfs_util.h"
+#include "ramrsbd_gf.h"
+#include "ramrsbd_gf_p.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Number of codewords the bitsliced encoder encodes at once
+//
+// This is the width of each bit plane, and must be a multiple of 64. The
+// speed profile defaults to 256 so planes fill wider vector registers.
+#ifndef RAMRSBD_RS_LANES
+#ifdef RAMRSBD_PROFILE_SPEED
+#define RAMRSBD_RS_LANES 256
+#else
+#define RAMRSBD_RS_LANES 64
+#endif
+#endif
+
+// Size of the bitsliced encoder's bit planes in bytes, see
+// ramrsbd_rs_encode_bitsliced
+#define RAMRSBD_RS_PLANES_SIZE(ecc_size) \
+    (((ecc_size)+8)*RAMRSBD_RS_LANES)
+
+// Size of a decode plan's tables in bytes, see ramrsbd_rs_plan
+#define RAMRSBD_RS_PLAN_SIZE(size) (3*(size))
+
+// Decode plan
+//
+// Tables that only depend on the number of positions in a codeword, so
+// the decoder doesn't need to recompute them for every codeword.
+// Positions are indexed from the end of the codeword, k = size-1-j, so
+// a plan works for any codeword up to size positions, and can be shared
+// by any number of codecs.
+typedef struct ramrsbd_rs_plan {
+    // Number of positions, at most 255.
+    lfs_size_t size;
+
+    // error locations X_k = g^k
+    const uint8_t *x; // size
+    // their inverses X_k^-1, the roots we look for in Λ(x), in log form
+    // since that's all we need to evaluate Λ(x) and Ω(x)
+    const uint8_t *l; // size
+    // log_g X_k^-2, for evaluating Λ'(x) at the roots
+    const uint8_t *l2; // size
+} ramrsbd_rs_plan_t;
+
+// Reed-Solomon codec
+//
+// This is everything needed to encode/decode codewords, independent of
+// any block device. Multiple codecs can share the same p, but each
+// thread decoding needs its own s, λ, and ω.
+typedef struct ramrsbd_rs {
+    // Size of a codeword in bytes, at most 255.
+    lfs_size_t code_size;
+
+    // Size of the error-correcting code in bytes.
+    lfs_size_t ecc_size;
+
+    // Number of byte errors to try to correct.
+    //
+    // By default, when zero, tries to correct as many errors as possible.
+    // -1 disables error correction and errors on any errors.
+    lfs_ssize_t error_correction;
+
+    // generator polynomial P(x), with implied leading 1, see ramrsbd_rs_p
+    const uint8_t *p; // ecc_size
+    // syndrome polynomial S(x)
+    uint8_t *s; // ecc_size
+    // error-locator polynomial Λ(x)
+    uint8_t *λ; // ecc_size
+    // error-evaluator polynomial Ω(x)
+    uint8_t *ω; // ecc_size
+
+    // Optional decode plan, with at least code_size positions.
+    //
+    // By default, when NULL, these are computed as needed.
+    const ramrsbd_rs_plan_t *plan;
+} ramrsbd_rs_t;
+
+// Streaming encoder state
+//
+// This finds the ecc of a message fed in arbitrarily sized chunks, so
+// the message never needs to be contiguous in memory.
+typedef struct ramrsbd_rs_enc {
+    // generator polynomial P(x), with implied leading 1
+    const uint8_t *p; // ecc_size
+    // running remainder, M(x) x^n mod P(x) so far
+    uint8_t *e; // ecc_size
+    lfs_size_t ecc_size;
+    lfs_size_t size;
+} ramrsbd_rs_enc_t;
+
+// Streaming syndrome state
+//
+// This finds the syndromes of a codeword fed in arbitrarily sized
+// chunks.
+typedef struct ramrsbd_rs_syn {
+    // syndromes so far
+    uint8_t *s; // ecc_size
+    lfs_size_t ecc_size;
+    lfs_size_t size;
+} ramrsbd_rs_syn_t;
+
+
+// Find the generator polynomial P(x) for ecc_size bytes of ecc
+//
+// P(x) has an implied leading 1, so p must be ecc_size.
+void ramrsbd_rs_p(uint8_t *p, lfs_size_t ecc_size);
+
+// Build a decode plan for codewords with up to size positions
+//
+// buffer must be RAMRSBD_RS_PLAN_SIZE(size), and must outlive the plan.
+void ramrsbd_rs_plan(ramrsbd_rs_plan_t *plan,
+        void *buffer, lfs_size_t size);
+
+// Encode an array of contiguous codewords in place
+//
+// Each codeword is a code_size-ecc_size message followed by ecc_size
+// bytes of ecc, which are overwritten.
+void ramrsbd_rs_encode(const ramrsbd_rs_t *rs,
+        void *buffer, lfs_size_t count);
+
+// Encode many codewords at once with a bitsliced encoder
+//
+// This transposes RAMRSBD_RS_LANES codewords at a time into bit planes,
+// one bit of every codeword per word, so multiplying by P(x)'s
+// coefficients becomes a fixed network of xors, without any tables or
+// branches. This scales with register width instead of memory latency,
+// but the transposes only pay off with many codewords.
+//
+// Messages are read from m + i*m_stride, and ecc_size bytes of ecc are
+// written to e + i*e_stride, so codewords don't need to be contiguous.
+//
+// planes provides RAMRSBD_RS_PLANES_SIZE(ecc_size) bytes of scratch.
+void ramrsbd_rs_encode_bitsliced(
+        const uint8_t *p, lfs_size_t ecc_size,
+        const void *m, lfs_size_t m_size, lfs_size_t m_stride,
+        void *e, lfs_size_t e_stride,
+        lfs_size_t count,
+        uint64_t *planes);
+
+// Decode an array of contiguous codewords in place
+//
+// If results is not NULL, the result for each codeword is written to
+// results[i]: 0 if clean, the number of byte errors corrected, or -1 if
+// uncorrectable. Uncorrectable codewords are left unmodified.
+//
+// Returns LFS_ERR_CORRUPT if any codeword is uncorrectable.
+int ramrsbd_rs_decode(const ramrsbd_rs_t *rs,
+        void *buffer, lfs_size_t count, int8_t *results);
+
+// Start encoding a message
+//
+// The generator polynomial p must have an implied leading 1, and e
+// provides ecc_size bytes for the running remainder.
+void ramrsbd_rs_enc_init(ramrsbd_rs_enc_t *enc,
+        const uint8_t *p, uint8_t *e, lfs_size_t ecc_size);
+
+// Feed the next part of a message into the encoder
+void ramrsbd_rs_enc_update(ramrsbd_rs_enc_t *enc,
+        const void *buffer, lfs_size_t size);
+
+// Finish encoding a message, writing ecc_size bytes of ecc
+//
+// The ecc buffer may be the encoder's e buffer.
+void ramrsbd_rs_enc_final(ramrsbd_rs_enc_t *enc, void *ecc);
+
+// Start finding the syndromes of a codeword
+//
+// s provides ecc_size bytes for the syndromes.
+void ramrsbd_rs_syn_init(ramrsbd_rs_syn_t *syn,
+        uint8_t *s, lfs_size_t ecc_size);
+
+// Feed the next part of a codeword, message then ecc, into the syndromes
+void ramrsbd_rs_syn_update(ramrsbd_rs_syn_t *syn,
+        const void *buffer, lfs_size_t size);
+
+// Finish finding the syndromes of a codeword
+//
+// The syndromes are left in s. Returns true if all syndromes are zero,
+// which means the codeword has no detectable errors.
+bool ramrsbd_rs_syn_final(ramrsbd_rs_syn_t *syn);
+
+// Find the error-locator polynomial Λ(x), given a set of syndromes S,
+// with C providing scratch space for interim math
+//
+// This is shared with the binary BCH codec. λ, c, and s must all be the
+// same size, with S_n at s[s_size-1-n].
+//
+// Returns the number of errors.
+lfs_size_t ramrsbd_rs_find_λ(
+        uint8_t *λ, lfs_size_t λ_size,
+        uint8_t *c, lfs_size_t c_size,
+        const uint8_t *s, lfs_size_t s_size);
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
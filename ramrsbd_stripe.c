@@ -0,0 +1,591 @@
+/*
+ * Erasure-coded striping across multiple ramrsbd instances
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "ramrsbd_stripe.h"
+#include "ramrsbd_gf.h"
+
+
+// some geometry helpers
+static inline lfs_size_t ramrsbd_stripe_count(
+        const ramrsbd_stripe_t *stripe) {
+    return stripe->cfg->data_count + stripe->cfg->parity_count;
+}
+
+static inline lfs_size_t ramrsbd_stripe_prog_size(
+        const ramrsbd_stripe_t *stripe) {
+    return stripe->cfg->shards[0]->prog_size;
+}
+
+// scratch space for shard s
+static inline uint8_t *ramrsbd_stripe_slot(
+        const ramrsbd_stripe_t *stripe, lfs_size_t s) {
+    return &stripe->buffer[s*ramrsbd_stripe_prog_size(stripe)];
+}
+
+
+// Generator matrix coefficients
+//
+// Data shards are the identity, parity shards are rows of the Cauchy
+// matrix 1/(x_j + y_i), with x_j = data_count+j and y_i = i. Every
+// square submatrix of a Cauchy matrix is invertible, so any data_count
+// rows of the generator matrix are invertible, and any data_count
+// shards can reconstruct the rest.
+//
+static uint8_t ramrsbd_stripe_coeff(const ramrsbd_stripe_t *stripe,
+        lfs_size_t s, lfs_size_t i) {
+    if (s < stripe->cfg->data_count) {
+        return (s == i) ? 1 : 0;
+    }
+
+    // s = data_count+j, and addition in GF(256) is xor
+    return ramrsbd_gf_div(1, (uint8_t)(s ^ i));
+}
+
+// compute parity shard j from data_count contiguous data chunks, each
+// the shards' prog_size apart
+static void ramrsbd_stripe_encode(const ramrsbd_stripe_t *stripe,
+        lfs_size_t j, const uint8_t *d, uint8_t *p, lfs_size_t size) {
+    lfs_size_t data_count = stripe->cfg->data_count;
+    lfs_size_t prog_size = ramrsbd_stripe_prog_size(stripe);
+
+    memset(p, 0, size);
+    for (lfs_size_t i = 0; i < data_count; i++) {
+        uint16_t l = ramrsbd_gf_log(
+                ramrsbd_stripe_coeff(stripe, data_count+j, i));
+        const uint8_t *d_ = &d[i*prog_size];
+        for (lfs_size_t x = 0; x < size; x++) {
+            p[x] ^= ramrsbd_gf_mull(d_[x], l);
+        }
+    }
+}
+
+// invert an n x n matrix with Gauss-Jordan elimination, m is destroyed
+// in the process
+static void ramrsbd_stripe_invert(uint8_t *m, uint8_t *inv,
+        lfs_size_t n) {
+    memset(inv, 0, n*n);
+    for (lfs_size_t i = 0; i < n; i++) {
+        inv[i*n+i] = 1;
+    }
+
+    for (lfs_size_t c = 0; c < n; c++) {
+        // find a pivot, our matrices are always invertible
+        lfs_size_t r = c;
+        while (r < n && m[r*n+c] == 0) {
+            r += 1;
+        }
+        LFS_ASSERT(r < n);
+
+        // swap into place
+        if (r != c) {
+            for (lfs_size_t k = 0; k < n; k++) {
+                uint8_t t = m[r*n+k];
+                m[r*n+k] = m[c*n+k];
+                m[c*n+k] = t;
+                t = inv[r*n+k];
+                inv[r*n+k] = inv[c*n+k];
+                inv[c*n+k] = t;
+            }
+        }
+
+        // normalize our pivot
+        uint16_t l = ramrsbd_gf_log(ramrsbd_gf_div(1, m[c*n+c]));
+        for (lfs_size_t k = 0; k < n; k++) {
+            m[c*n+k] = ramrsbd_gf_mull(m[c*n+k], l);
+            inv[c*n+k] = ramrsbd_gf_mull(inv[c*n+k], l);
+        }
+
+        // and eliminate the column from every other row
+        for (r = 0; r < n; r++) {
+            if (r == c || m[r*n+c] == 0) {
+                continue;
+            }
+
+            uint16_t l_ = ramrsbd_gf_log(m[r*n+c]);
+            for (lfs_size_t k = 0; k < n; k++) {
+                m[r*n+k] ^= ramrsbd_gf_mull(m[c*n+k], l_);
+                inv[r*n+k] ^= ramrsbd_gf_mull(inv[c*n+k], l_);
+            }
+        }
+    }
+}
+
+
+// Shard requests
+//
+// Requests are submitted to every shard before waiting on any of them,
+// so shards with workers can make progress in parallel.
+//
+static void ramrsbd_stripe_submit(ramrsbd_stripe_t *stripe,
+        lfs_size_t s, enum ramrsbd_op op,
+        lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size) {
+    struct ramrsbd_stripe_shard *shard = &stripe->shards[s];
+    shard->req = (struct ramrsbd_req){
+        .op = op,
+        .block = block,
+        .off = off,
+        .buffer = buffer,
+        .size = size,
+    };
+    int err = ramrsbd_submit(stripe->cfg->shards[s], &shard->req);
+    if (err) {
+        // never submitted, but make it look like it failed
+        shard->req.err = err;
+        shard->req.done = true;
+    }
+}
+
+// wait on every request submitted since the last wait, returning the
+// first error, results are left in each shard's req.err
+static int ramrsbd_stripe_wait(ramrsbd_stripe_t *stripe) {
+    int err = 0;
+    for (lfs_size_t s = 0; s < ramrsbd_stripe_count(stripe); s++) {
+        struct ramrsbd_stripe_shard *shard = &stripe->shards[s];
+        if (!shard->req.op) {
+            continue;
+        }
+
+        int err_ = ramrsbd_wait(stripe->cfg->shards[s], &shard->req);
+        if (err_ && !err) {
+            err = err_;
+        }
+        shard->req.op = 0;
+    }
+
+    return err;
+}
+
+// read a range of a row from every available shard, reconstructing any
+// missing data shards into their scratch space
+//
+// off and size are in shard space, and off must be the start of a row's
+// chunk or inside it.
+static int ramrsbd_stripe_recover(ramrsbd_stripe_t *stripe,
+        lfs_block_t block, lfs_off_t off, lfs_size_t size) {
+    lfs_size_t data_count = stripe->cfg->data_count;
+    lfs_size_t count = ramrsbd_stripe_count(stripe);
+
+    // read from every shard we can
+    for (lfs_size_t s = 0; s < count; s++) {
+        if (!stripe->shards[s].lost) {
+            ramrsbd_stripe_submit(stripe, s, RAMRSBD_OP_READ,
+                    block, off, ramrsbd_stripe_slot(stripe, s), size);
+        }
+    }
+    ramrsbd_stripe_wait(stripe);
+
+    // pick data_count readable shards, preferring data shards
+    uint8_t *m = &stripe->buffer[count*ramrsbd_stripe_prog_size(stripe)];
+    uint8_t *inv = &m[data_count*data_count];
+    uint8_t *rows = &inv[data_count*data_count];
+    lfs_size_t found = 0;
+    bool missing = false;
+    for (lfs_size_t s = 0; s < count && found < data_count; s++) {
+        if (!stripe->shards[s].lost && stripe->shards[s].req.err == 0) {
+            rows[found] = s;
+            found += 1;
+        } else if (s < data_count) {
+            missing = true;
+        }
+    }
+
+    if (found < data_count) {
+        LFS_WARN("Found uncorrectable ramrsbd stripe "
+                "0x%"PRIx32".%"PRIx32" "
+                "(%"PRIu32" of %"PRIu32" shards readable)",
+                block, off, found, data_count);
+        return LFS_ERR_CORRUPT;
+    }
+
+    if (!missing) {
+        return 0;
+    }
+
+    // invert the generator rows of the shards we did read, this maps
+    // their contents back to the original data
+    for (lfs_size_t k = 0; k < data_count; k++) {
+        for (lfs_size_t i = 0; i < data_count; i++) {
+            m[k*data_count+i] = ramrsbd_stripe_coeff(stripe, rows[k], i);
+        }
+    }
+    ramrsbd_stripe_invert(m, inv, data_count);
+
+    // and reconstruct any missing data shards
+    for (lfs_size_t i = 0; i < data_count; i++) {
+        if (!stripe->shards[i].lost && stripe->shards[i].req.err == 0) {
+            continue;
+        }
+
+        uint8_t *d = ramrsbd_stripe_slot(stripe, i);
+        memset(d, 0, size);
+        for (lfs_size_t k = 0; k < data_count; k++) {
+            uint16_t l = ramrsbd_gf_log(inv[i*data_count+k]);
+            const uint8_t *v = ramrsbd_stripe_slot(stripe, rows[k]);
+            for (lfs_size_t x = 0; x < size; x++) {
+                d[x] ^= ramrsbd_gf_mull(v[x], l);
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+// Stripe creation and destruction
+int ramrsbd_stripe_create(const struct lfs_config *cfg,
+        const struct ramrsbd_stripe_config *stripecfg) {
+    RAMRSBD_TRACE("ramrsbd_stripe_create(%p {.context=%p, "
+                ".read=%p, .prog=%p, .erase=%p, .sync=%p}, "
+                "%p {.shards=%p, "
+                ".data_count=%"PRIu32", .parity_count=%"PRIu32", "
+                ".shard_buffer=%p, .buffer=%p})",
+            (void*)cfg, cfg->context,
+            (void*)(uintptr_t)cfg->read, (void*)(uintptr_t)cfg->prog,
+            (void*)(uintptr_t)cfg->erase, (void*)(uintptr_t)cfg->sync,
+            (void*)stripecfg, (void*)stripecfg->shards,
+            stripecfg->data_count, stripecfg->parity_count,
+            stripecfg->shard_buffer, stripecfg->buffer);
+    ramrsbd_stripe_t *stripe = cfg->context;
+    stripe->cfg = stripecfg;
+
+    // we need at least one data shard, and our Cauchy matrix needs
+    // unique elements for every shard
+    LFS_ASSERT(stripe->cfg->data_count > 0);
+    LFS_ASSERT(stripe->cfg->data_count + stripe->cfg->parity_count
+            <= 256);
+
+    // shards must share the same geometry
+    const struct lfs_config *shard = stripe->cfg->shards[0];
+    for (lfs_size_t s = 1; s < ramrsbd_stripe_count(stripe); s++) {
+        LFS_ASSERT(stripe->cfg->shards[s]->read_size == shard->read_size);
+        LFS_ASSERT(stripe->cfg->shards[s]->prog_size == shard->prog_size);
+        LFS_ASSERT(stripe->cfg->shards[s]->block_size
+                == shard->block_size);
+        LFS_ASSERT(stripe->cfg->shards[s]->block_count
+                == shard->block_count);
+    }
+
+    // and our geometry must match theirs
+    LFS_ASSERT(shard->prog_size % shard->read_size == 0);
+    LFS_ASSERT(cfg->read_size == shard->read_size);
+    LFS_ASSERT(cfg->prog_size == stripe->cfg->data_count*shard->prog_size);
+    LFS_ASSERT(cfg->block_size
+            == stripe->cfg->data_count*shard->block_size);
+    LFS_ASSERT(cfg->block_count == shard->block_count);
+
+    // allocate shard state?
+    if (stripe->cfg->shard_buffer) {
+        stripe->shards = stripe->cfg->shard_buffer;
+    } else {
+        stripe->shards = lfs_malloc(ramrsbd_stripe_count(stripe)
+                * sizeof(struct ramrsbd_stripe_shard));
+        if (!stripe->shards) {
+            RAMRSBD_TRACE("ramrsbd_stripe_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
+    }
+
+    for (lfs_size_t s = 0; s < ramrsbd_stripe_count(stripe); s++) {
+        stripe->shards[s].req.op = 0;
+        stripe->shards[s].lost = false;
+    }
+
+    // allocate scratch buffer?
+    if (stripe->cfg->buffer) {
+        stripe->buffer = stripe->cfg->buffer;
+    } else {
+        stripe->buffer = lfs_malloc(
+                ramrsbd_stripe_count(stripe)*shard->prog_size
+                    + stripe->cfg->data_count
+                        * (2*stripe->cfg->data_count+1));
+        if (!stripe->buffer) {
+            RAMRSBD_TRACE("ramrsbd_stripe_create -> %d", LFS_ERR_NOMEM);
+            return LFS_ERR_NOMEM;
+        }
+    }
+
+    RAMRSBD_TRACE("ramrsbd_stripe_create -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_stripe_destroy(const struct lfs_config *cfg) {
+    RAMRSBD_TRACE("ramrsbd_stripe_destroy(%p)", (void*)cfg);
+    ramrsbd_stripe_t *stripe = cfg->context;
+
+    if (!stripe->cfg->shard_buffer) {
+        lfs_free(stripe->shards);
+    }
+    if (!stripe->cfg->buffer) {
+        lfs_free(stripe->buffer);
+    }
+
+    RAMRSBD_TRACE("ramrsbd_stripe_destroy -> %d", 0);
+    return 0;
+}
+
+
+// Block device operations
+
+// find the part of a row that lands on data shard i, returns false if
+// the row doesn't touch the shard
+//
+// row_off and row_size describe the range in the row, the shard offset
+// and offset into the row are written to off_ and row_off_.
+static bool ramrsbd_stripe_piece(const ramrsbd_stripe_t *stripe,
+        lfs_size_t i, lfs_off_t row, lfs_off_t row_off, lfs_size_t row_size,
+        lfs_off_t *off_, lfs_off_t *row_off_, lfs_size_t *size_) {
+    lfs_size_t prog_size = ramrsbd_stripe_prog_size(stripe);
+    lfs_off_t lo = lfs_max(row_off, i*prog_size);
+    lfs_off_t hi = lfs_min(row_off+row_size, (i+1)*prog_size);
+    if (lo >= hi) {
+        return false;
+    }
+
+    *off_ = row*prog_size + (lo - i*prog_size);
+    *row_off_ = lo;
+    *size_ = hi - lo;
+    return true;
+}
+
+int ramrsbd_stripe_read(const struct lfs_config *cfg, lfs_block_t block,
+        lfs_off_t off, void *buffer, lfs_size_t size) {
+    RAMRSBD_TRACE("ramrsbd_stripe_read(%p, "
+                "0x%"PRIx32", %"PRIu32", %p, %"PRIu32")",
+            (void*)cfg, block, off, buffer, size);
+    ramrsbd_stripe_t *stripe = cfg->context;
+
+    // check if read is valid
+    LFS_ASSERT(block < cfg->block_count);
+    LFS_ASSERT(off  % cfg->read_size == 0);
+    LFS_ASSERT(size % cfg->read_size == 0);
+    LFS_ASSERT(off+size <= cfg->block_size);
+
+    lfs_size_t data_count = stripe->cfg->data_count;
+    lfs_size_t prog_size = ramrsbd_stripe_prog_size(stripe);
+    uint8_t *buffer_ = buffer;
+    while (size > 0) {
+        lfs_off_t row = off / cfg->prog_size;
+        lfs_off_t row_off = off % cfg->prog_size;
+        lfs_size_t row_size = lfs_min(cfg->prog_size - row_off, size);
+
+        // read from each data shard in the row
+        bool missing = false;
+        for (lfs_size_t i = 0; i < data_count; i++) {
+            lfs_off_t off_;
+            lfs_off_t row_off_;
+            lfs_size_t size_;
+            if (!ramrsbd_stripe_piece(stripe, i, row, row_off, row_size,
+                    &off_, &row_off_, &size_)) {
+                continue;
+            }
+
+            if (stripe->shards[i].lost) {
+                missing = true;
+                continue;
+            }
+
+            ramrsbd_stripe_submit(stripe, i, RAMRSBD_OP_READ,
+                    block, off_, &buffer_[row_off_-row_off], size_);
+        }
+
+        // reconstruct anything we couldn't read, for any reason
+        int err = ramrsbd_stripe_wait(stripe);
+        if (missing || err) {
+            // if the row touches multiple shards, just reconstruct
+            // whole chunks, this way we only need one pass
+            lfs_off_t lo = 0;
+            lfs_off_t hi = prog_size;
+            if (row_off/prog_size == (row_off+row_size-1)/prog_size) {
+                lo = row_off % prog_size;
+                hi = lo + row_size;
+            }
+            err = ramrsbd_stripe_recover(stripe, block,
+                    row*prog_size + lo, hi - lo);
+            if (err) {
+                RAMRSBD_TRACE("ramrsbd_stripe_read -> %d", err);
+                return err;
+            }
+
+            for (lfs_size_t i = 0; i < data_count; i++) {
+                lfs_off_t off_;
+                lfs_off_t row_off_;
+                lfs_size_t size_;
+                if (!ramrsbd_stripe_piece(stripe, i, row, row_off, row_size,
+                        &off_, &row_off_, &size_)) {
+                    continue;
+                }
+
+                memcpy(&buffer_[row_off_-row_off],
+                        &ramrsbd_stripe_slot(stripe, i)[
+                            off_ - (row*prog_size + lo)],
+                        size_);
+            }
+        }
+
+        off += row_size;
+        buffer_ += row_size;
+        size -= row_size;
+    }
+
+    RAMRSBD_TRACE("ramrsbd_stripe_read -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_stripe_prog(const struct lfs_config *cfg, lfs_block_t block,
+        lfs_off_t off, const void *buffer, lfs_size_t size) {
+    RAMRSBD_TRACE("ramrsbd_stripe_prog(%p, "
+                "0x%"PRIx32", %"PRIu32", %p, %"PRIu32")",
+            (void*)cfg, block, off, buffer, size);
+    ramrsbd_stripe_t *stripe = cfg->context;
+
+    // check if write is valid
+    LFS_ASSERT(block < cfg->block_count);
+    LFS_ASSERT(off  % cfg->prog_size == 0);
+    LFS_ASSERT(size % cfg->prog_size == 0);
+    LFS_ASSERT(off+size <= cfg->block_size);
+
+    lfs_size_t data_count = stripe->cfg->data_count;
+    lfs_size_t prog_size = ramrsbd_stripe_prog_size(stripe);
+    const uint8_t *buffer_ = buffer;
+    while (size > 0) {
+        lfs_off_t off_ = (off / cfg->prog_size) * prog_size;
+
+        // prog the data shards first, these can start encoding while
+        // we compute parity
+        for (lfs_size_t i = 0; i < data_count; i++) {
+            if (!stripe->shards[i].lost) {
+                ramrsbd_stripe_submit(stripe, i, RAMRSBD_OP_PROG,
+                        block, off_, (void*)&buffer_[i*prog_size],
+                        prog_size);
+            }
+        }
+
+        for (lfs_size_t j = 0; j < stripe->cfg->parity_count; j++) {
+            if (!stripe->shards[data_count+j].lost) {
+                uint8_t *p = ramrsbd_stripe_slot(stripe, data_count+j);
+                ramrsbd_stripe_encode(stripe, j, buffer_, p, prog_size);
+                ramrsbd_stripe_submit(stripe, data_count+j,
+                        RAMRSBD_OP_PROG,
+                        block, off_, p, prog_size);
+            }
+        }
+
+        int err = ramrsbd_stripe_wait(stripe);
+        if (err) {
+            RAMRSBD_TRACE("ramrsbd_stripe_prog -> %d", err);
+            return err;
+        }
+
+        off += cfg->prog_size;
+        buffer_ += cfg->prog_size;
+        size -= cfg->prog_size;
+    }
+
+    RAMRSBD_TRACE("ramrsbd_stripe_prog -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_stripe_erase(const struct lfs_config *cfg, lfs_block_t block) {
+    RAMRSBD_TRACE("ramrsbd_stripe_erase(%p, 0x%"PRIx32")",
+            (void*)cfg, block);
+    ramrsbd_stripe_t *stripe = cfg->context;
+
+    // check if erase is valid
+    LFS_ASSERT(block < cfg->block_count);
+
+    for (lfs_size_t s = 0; s < ramrsbd_stripe_count(stripe); s++) {
+        if (!stripe->shards[s].lost) {
+            ramrsbd_stripe_submit(stripe, s, RAMRSBD_OP_ERASE,
+                    block, 0, NULL, 0);
+        }
+    }
+
+    int err = ramrsbd_stripe_wait(stripe);
+    RAMRSBD_TRACE("ramrsbd_stripe_erase -> %d", err);
+    return err;
+}
+
+int ramrsbd_stripe_sync(const struct lfs_config *cfg) {
+    RAMRSBD_TRACE("ramrsbd_stripe_sync(%p)", (void*)cfg);
+    ramrsbd_stripe_t *stripe = cfg->context;
+
+    for (lfs_size_t s = 0; s < ramrsbd_stripe_count(stripe); s++) {
+        if (!stripe->shards[s].lost) {
+            ramrsbd_stripe_submit(stripe, s, RAMRSBD_OP_SYNC,
+                    0, 0, NULL, 0);
+        }
+    }
+
+    int err = ramrsbd_stripe_wait(stripe);
+    RAMRSBD_TRACE("ramrsbd_stripe_sync -> %d", err);
+    return err;
+}
+
+
+// Shard management
+int ramrsbd_stripe_lose(const struct lfs_config *cfg, lfs_size_t shard) {
+    RAMRSBD_TRACE("ramrsbd_stripe_lose(%p, %"PRIu32")",
+            (void*)cfg, shard);
+    ramrsbd_stripe_t *stripe = cfg->context;
+    LFS_ASSERT(shard < ramrsbd_stripe_count(stripe));
+
+    stripe->shards[shard].lost = true;
+
+    RAMRSBD_TRACE("ramrsbd_stripe_lose -> %d", 0);
+    return 0;
+}
+
+int ramrsbd_stripe_rebuild(const struct lfs_config *cfg, lfs_size_t shard) {
+    RAMRSBD_TRACE("ramrsbd_stripe_rebuild(%p, %"PRIu32")",
+            (void*)cfg, shard);
+    ramrsbd_stripe_t *stripe = cfg->context;
+    LFS_ASSERT(shard < ramrsbd_stripe_count(stripe));
+
+    // make sure we don't try to read from the shard we're rebuilding
+    stripe->shards[shard].lost = true;
+
+    lfs_size_t data_count = stripe->cfg->data_count;
+    const struct lfs_config *shardcfg = stripe->cfg->shards[shard];
+    for (lfs_block_t block = 0; block < cfg->block_count; block++) {
+        int err = ramrsbd_erase(shardcfg, block);
+        if (err) {
+            RAMRSBD_TRACE("ramrsbd_stripe_rebuild -> %d", err);
+            return err;
+        }
+
+        for (lfs_off_t off = 0;
+                off < shardcfg->block_size;
+                off += shardcfg->prog_size) {
+            // reconstruct our data shards
+            err = ramrsbd_stripe_recover(stripe, block,
+                    off, shardcfg->prog_size);
+            if (err) {
+                RAMRSBD_TRACE("ramrsbd_stripe_rebuild -> %d", err);
+                return err;
+            }
+
+            // recompute parity if we're a parity shard
+            uint8_t *c = ramrsbd_stripe_slot(stripe, shard);
+            if (shard >= data_count) {
+                ramrsbd_stripe_encode(stripe, shard-data_count,
+                        ramrsbd_stripe_slot(stripe, 0),
+                        c, shardcfg->prog_size);
+            }
+
+            err = ramrsbd_prog(shardcfg, block, off,
+                    c, shardcfg->prog_size);
+            if (err) {
+                RAMRSBD_TRACE("ramrsbd_stripe_rebuild -> %d", err);
+                return err;
+            }
+        }
+    }
+
+    stripe->shards[shard].lost = false;
+
+    RAMRSBD_TRACE("ramrsbd_stripe_rebuild -> %d", 0);
+    return 0;
+}
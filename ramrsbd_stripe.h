@@ -0,0 +1,152 @@
+/*
+ * Erasure-coded striping across multiple ramrsbd instances
+ *
+ * Copyright (c) 2024, The littlefs authors.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef RAMRSBD_STRIPE_H
+#define RAMRSBD_STRIPE_H
+
+#include "lfs.h"
+#include "lfs_util.h"
+#include "ramrsbd.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Erasure-coded striping
+//
+// A stripe presents data_count+parity_count ramrsbd instances, the
+// shards, as a single littlefs block device that survives the loss of
+// any parity_count shards. Compared to mirroring, which needs 3x the
+// storage to survive the loss of 2 devices, a stripe only needs
+// (data_count+parity_count)/data_count.
+//
+// Each prog is split into rows of data_count shard-sized progs, one per
+// data shard. Each parity shard stores a linear combination of the data
+// shards over GF(256), using the rows of a Cauchy matrix, so any
+// data_count shards are enough to reconstruct the rest. Requests to
+// each shard are submitted together with ramrsbd_submit, so shards with
+// workers encode and decode in parallel.
+//
+// Shards must share the same geometry, with prog_size a multiple of
+// read_size, and the stripe's block device must be configured with:
+//
+// - read_size = the shards' read_size
+// - prog_size = data_count * the shards' prog_size
+// - block_size = data_count * the shards' block_size
+// - block_count = the shards' block_count
+//
+// If a shard reports an uncorrectable read, the stripe reconstructs the
+// data from the other shards. Shards can also be marked as lost, see
+// ramrsbd_stripe_lose, in which case they are ignored until rebuilt,
+// see ramrsbd_stripe_rebuild.
+//
+// Unlike ramrsbd, a stripe is not thread-safe.
+
+struct ramrsbd_stripe_config {
+    // Block devices of each shard, data shards followed by parity
+    // shards, the context of each must be a ramrsbd_t.
+    const struct lfs_config *const *shards;
+
+    // Number of data shards.
+    lfs_size_t data_count;
+
+    // Number of parity shards, at most 256-data_count.
+    lfs_size_t parity_count;
+
+    // Optional statically allocated shard state buffer.
+    //
+    // Must be (data_count+parity_count)
+    //      * sizeof(struct ramrsbd_stripe_shard).
+    void *shard_buffer;
+
+    // Optional statically allocated scratch buffer for computing parity
+    // and reconstructing data.
+    //
+    // Must be (data_count+parity_count)*prog_size
+    //      + data_count*(2*data_count+1),
+    //
+    // where prog_size is the shards' prog_size.
+    void *buffer;
+};
+
+// Per-shard state
+struct ramrsbd_stripe_shard {
+    // in-flight request
+    struct ramrsbd_req req;
+    // shard has been lost and should be ignored
+    bool lost;
+};
+
+// stripe state
+typedef struct ramrsbd_stripe {
+    const struct ramrsbd_stripe_config *cfg;
+    // shard state
+    struct ramrsbd_stripe_shard *shards; // data_count+parity_count
+    // scratch space, one shard-sized prog per shard, followed by a
+    // data_count x data_count matrix, its inverse, and the shards used
+    // to reconstruct
+    uint8_t *buffer;
+} ramrsbd_stripe_t;
+
+
+// Create a stripe using the geometry in cfg
+//
+// The shards must already be created, and outlive the stripe.
+int ramrsbd_stripe_create(const struct lfs_config *cfg,
+        const struct ramrsbd_stripe_config *stripecfg);
+
+// Clean up memory associated with the stripe
+//
+// This does not destroy the shards.
+int ramrsbd_stripe_destroy(const struct lfs_config *cfg);
+
+// Read a block
+//
+// Returns LFS_ERR_CORRUPT if more than parity_count shards are lost or
+// unreadable.
+int ramrsbd_stripe_read(const struct lfs_config *cfg, lfs_block_t block,
+        lfs_off_t off, void *buffer, lfs_size_t size);
+
+// Program a block
+//
+// The block must have previously been erased. Lost shards are skipped.
+int ramrsbd_stripe_prog(const struct lfs_config *cfg, lfs_block_t block,
+        lfs_off_t off, const void *buffer, lfs_size_t size);
+
+// Erase a block
+//
+// Lost shards are skipped.
+int ramrsbd_stripe_erase(const struct lfs_config *cfg, lfs_block_t block);
+
+// Sync the block device
+//
+// Lost shards are skipped.
+int ramrsbd_stripe_sync(const struct lfs_config *cfg);
+
+// Mark a shard as lost
+//
+// Lost shards are no longer read or progged, data is reconstructed
+// from the remaining shards instead.
+int ramrsbd_stripe_lose(const struct lfs_config *cfg, lfs_size_t shard);
+
+// Rebuild a lost shard
+//
+// The shard's ramrsbd, which may have been recreated, is rewritten
+// block by block from the remaining shards, and is no longer marked as
+// lost.
+//
+// Returns LFS_ERR_CORRUPT if too many other shards are lost or
+// unreadable.
+int ramrsbd_stripe_rebuild(const struct lfs_config *cfg, lfs_size_t shard);
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
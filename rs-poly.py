@@ -8,8 +8,22 @@ import operator as op
 GF_POW = []
 GF_LOG = []
 
+# carry-less multiplication mod p, this is slow but doesn't need any
+# tables
+def gf_mul_slow(a, b, p):
+    x = 0
+    for i in range(8):
+        if b & (1 << i):
+            x ^= a << i
+
+    for i in reversed(range(8, 16)):
+        if x & (1 << i):
+            x ^= p << (i-8)
+
+    return x
+
 # build the GF_POW/GF_LOG tables
-def build_gf_tables(p):
+def build_gf_tables(p, g):
     global GF_POW
     global GF_LOG
     pow_table = []
@@ -21,9 +35,7 @@ def build_gf_tables(p):
         if x not in log_table:
             log_table[x] = i
 
-        x <<= 1
-        if x & 0x100:
-            x ^= p
+        x = gf_mul_slow(x, g, p)
 
     GF_POW = pow_table
     GF_LOG = [log_table.get(i, 0xff) for i in range(256)]
@@ -95,27 +107,62 @@ def gf_p_divmod(a, b):
 
 def main(ecc_size, *,
         p=None,
+        g=None,
+        bch=False,
         no_truncate=False):
-    # first build our GF_POW/GF_LOG tables based on p
-    build_gf_tables(p)
-
-    # calculate generator polynomial
-    #
-    # P(x) = prod_i^n-1 (x - g^i)
-    #
-    # the important property of P(x) is that it evaluates to 0
-    # at every x=g^i for i < n
-    #
-    p = ft.reduce(
-        gf_p_mul,
-        ([1, gf_pow(2, i)] for i in range(ecc_size)),
-        [1])
-
-    # print the generator polynomial
-    print("// generator polynomial for ecc_size=%s" % ecc_size)
-    print("//")
-    print("// P(x) = prod_i^n-1 (x - g^i)")
-    print("//")
+    # first build our GF_POW/GF_LOG tables based on p and g
+    build_gf_tables(p, g)
+
+    if bch:
+        # calculate binary BCH generator polynomial
+        #
+        # P(x) = prod_i M_i(x) for odd i < 2n
+        #
+        # where M_i(x) = prod_j (x - g^j) for j in {i, 2i, 4i, ...} mod 255
+        # is the minimal binary polynomial with g^i as a root
+        #
+        p = [1]
+        for i in range(1, 2*ecc_size, 2):
+            coset = {(i << k) % 255 for k in range(8)}
+            if min(coset) < i:
+                continue
+
+            m = ft.reduce(
+                gf_p_mul,
+                ([1, gf_pow(g, j)] for j in sorted(coset)),
+                [1])
+            assert all(m_ in [0, 1] for m_ in m)
+            p = gf_p_mul(p, m)
+
+        # shift up to fill 8n bits, and pack into bytes
+        p = p + [0]*(8*ecc_size+1 - len(p))
+        p = [1] + [
+            int(''.join('%d' % b for b in p[1+8*i:1+8*(i+1)]), 2)
+            for i in range(ecc_size)]
+
+        # print the generator polynomial
+        print("// binary BCH generator polynomial for ecc_size=%s" % ecc_size)
+        print("//")
+        print("// P(x) = prod_i M_i(x) for odd i < 2n")
+        print("//")
+    else:
+        # calculate generator polynomial
+        #
+        # P(x) = prod_i^n-1 (x - g^i)
+        #
+        # the important property of P(x) is that it evaluates to 0
+        # at every x=g^i for i < n
+        #
+        p = ft.reduce(
+            gf_p_mul,
+            ([1, gf_pow(g, i)] for i in range(ecc_size)),
+            [1])
+
+        # print the generator polynomial
+        print("// generator polynomial for ecc_size=%s" % ecc_size)
+        print("//")
+        print("// P(x) = prod_i^n-1 (x - g^i)")
+        print("//")
     print("static const uint8_t RAMRSBD_P[%s] = {" % (
         len(p) if no_truncate else len(p[1:])))
     if no_truncate:
@@ -152,6 +199,16 @@ if __name__ == "__main__":
         default=0x11d,
         help="The irreducible polynomial that defines the field. Defaults to "
             "0x11d")
+    parser.add_argument(
+        '-g',
+        type=lambda x: int(x, 0),
+        default=0x02,
+        help="A generator element in the field. Defaults to 2.")
+    parser.add_argument(
+        '-b', '--bch',
+        action='store_true',
+        help="Generate a binary BCH generator polynomial instead, packed one "
+            "bit per term.")
     parser.add_argument(
         '-T', '--no-truncate',
         action='store_true',